@@ -33,3 +33,7 @@ void mul9x9mod(uint64_t *b, const uint64_t *a);
 
 __attribute__((target ("default")))
 void mul9x9mod(uint64_t *b, const uint64_t *a);
+
+// modular exponentiation:
+// x <- x^n mod (2^576 - 2^240 + 1)
+void powmod(uint64_t *x, unsigned long int n);
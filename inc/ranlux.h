@@ -30,13 +30,45 @@
 #include <stdint.h>
 #include "immintrin.h"
 #include "ranluxpp.h"
+#include <memory>
 
 #pragma once
 
 #define   likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
-class ranluxI_scalar {
+// The diagnostic messages of the generators -- the skipping set up by
+// the constructors, the reports of the FORTRAN emulations -- are passed
+// to the logging callback as complete lines with the trailing newline.
+// No callback is installed by default, then nothing is formatted or
+// printed. f = NULL removes the callback, the previous one is returned.
+typedef void (*ranlux_logger)(const char *msg);
+ranlux_logger ranlux_setlogger(ranlux_logger f);
+
+// Binary checkpoint of the ranluxI_* generators: the header is followed
+// by the state vectors in the memory layout of the generator and by the
+// carry bits of the generators as 32-bit words. The SIMD generators in
+// the sequence mode save the current block as ranluxI_scalar does, so the
+// checkpoint can be loaded to either of them.
+struct ranluxI_checkpoint {
+  enum { SCALAR = 1, // 24 32-bit numbers
+	 SCALAR48,   // 12 64-bit numbers
+	 MULTI,      // 24 32-bit numbers of every generator in turn
+	 SIMD };     // 24 vectors of 32-bit numbers of nlanes generators
+  uint32_t magic;  // "RLXI"
+  uint16_t kind;   // layout of the state vectors
+  uint16_t nlanes; // number of generators
+  int32_t p;       // number of states to skip
+  int32_t pos;     // current position in the state vectors
+};
+
+// transform the state of the generator lane of the checkpoint of size
+// bytes to the LCG state (the position in the state vector is not a part
+// of it), returns false for a malformed or truncated checkpoint or a
+// missing lane
+bool getlcgstate(uint64_t x[9], const ranluxI_checkpoint *cp, size_t size, int lane = 0);
+
+class ranluxI_scalar : public ranluxcounted {
 protected:
   uint32_t _x[24]; // state vector - only lower 24 bits are random!
   uint32_t _c;     // carry bit
@@ -48,8 +80,16 @@ public:
   ranluxI_scalar(int seed, int lux);
   void init(int seed);
   void nextstate(int nstates);
+  // skip nstates states, for large nstates via the equivalent LCG
+  // in O(log(nstates)) modular multiplications
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
   float operator()(){
-    if(unlikely(_pos>=24)){_pos = 0; nextstate(_p);}
+    if(unlikely(_pos>=24)){_pos = 0; nextstate(_p); countrefill((uint64_t)(_p - 1)*RANLUX_STATE_BITS);}
     return ((int32_t*)_x)[_pos++]*(1.0f/0x1p24f);
   }
   void getstate(uint32_t *x, uint32_t &c){
@@ -69,19 +109,130 @@ public:
   }
 };
 
-class ranluxI_SSE {
+// The subtract-with-borrow generator with the base 2^48 and the lags
+// r = 12, s = 5 has the same modulus m = 2^576 - 2^240 + 1 as the 24-bit
+// one and half the number of steps per state. Its state is the state of
+// ranluxI_scalar with the pairs of the consecutive 24-bit numbers joined,
+// x48[i] = x24[2*i]*2^24 + x24[2*i+1], and the same carry, so with the
+// same seed and luxury it delivers the numbers of ranluxI_scalar in pairs
+// as 48-bit doubles.
+class ranluxI48_scalar : public ranluxcounted {
+protected:
+  uint64_t _x[12]; // state vector - only lower 48 bits are random!
+  uint32_t _c;     // carry bit
+  int _p;          // number of states to skip
+  int _pos;        // current position in the state vector
+public:
+  ranluxI48_scalar(int seed):ranluxI48_scalar(seed,17){};
+  ranluxI48_scalar(int seed, int lux);
+  void init(int seed);
+  void nextstate(int nstates);
+  // skip nstates states, for large nstates via the equivalent LCG
+  // in O(log(nstates)) modular multiplications
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
+  double operator()(){
+    if(unlikely(_pos>=12)){_pos = 0; nextstate(_p); countrefill((uint64_t)(_p - 1)*RANLUX_STATE_BITS);}
+    return (int64_t)_x[_pos++]*(1.0/0x1p48);
+  }
+  // the equivalent state of ranluxI_scalar
+  void getstate(uint32_t *x, uint32_t &c);
+  void setstate(const uint32_t *x, uint32_t c);
+};
+
+// N = 2 or 4 independent scalar generators advanced together, their
+// carry chains interleave and fill the execution ports of CPUs without
+// (or with disabled) SIMD extensions
+template<int N>
+class ranluxI_multi : public ranluxcounted {
+protected:
+  uint32_t _x[N][24]; // state vectors - only lower 24 bits are random!
+  uint32_t _c[N];     // carry bits
+  int _p;             // number of states to skip
+  int _pos;           // current position in the state vectors
+public:
+  ranluxI_multi(int seed):ranluxI_multi(seed,17){};
+  ranluxI_multi(int seed, int lux);
+  void init(int seed, bool sameseed=0);
+  void nextstate(int nstates);
+  // skip nstates states of every generator, for large nstates via
+  // the equivalent LCG in O(log(nstates)) modular multiplications
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
+  // the generators deliver their blocks one after another
+  float operator()(){
+    if(unlikely(_pos>=N*24)){_pos = 0; nextstate(_p); countrefill((uint64_t)N*(_p - 1)*RANLUX_STATE_BITS);}
+    return ((int32_t*)_x)[_pos++]*(1.0f/0x1p24f);
+  }
+};
+
+class ranluxI_SSE : public ranluxcounted {
 protected:
   __m128i _x[24]; // state vector - 4 parallel states with 32 bits, only lower 24 bits are random
   __m128i _c;     // carry bits
   int _p;         // number of states to skip
-  int _pos;       // current position in the state vector
+  int _pos;       // current position in the state vector (in the buffer in the sequence mode)
+  bool _seq;      // the generators deliver consecutive blocks of one sequence
+
+  // In the sequence mode every generator produces a segment of _nblk
+  // consecutive blocks of the ranluxI_scalar sequence, the segments of
+  // the generators follow each other. The blocks are buffered and then
+  // the generators jump over the segments of the others via the LCG.
+  static const int _nblk = 32;
+  struct seqbuffer {
+    __m128i y[24*_nblk]; // buffered blocks of all generators
+    __m128i cy[_nblk];   // carry bits of the buffered blocks
+    uint64_t A[9];       // LCG multiplier to the next segment of a generator
+  };
+  // allocated by the sequence mode only, released by init
+  std::unique_ptr<seqbuffer> _sb;
+
+  // continue the scalar sequence from its block x0, c0 with pos numbers
+  // of the block already delivered
+  void setsequence(const uint32_t *x0, uint32_t c0, int pos);
+  // fill the buffer and move the generators to their next segments
+  void nextsequence();
+  // the state of the current block of the sequence and the number of
+  // its delivered numbers
+  void getblock(uint32_t *x, uint32_t &c, int &pos) const;
 public:
   ranluxI_SSE(int seed):ranluxI_SSE(seed,17){};
   ranluxI_SSE(int seed, int lux);
   void init(int seed, bool sameseed=0);
+  // switch to the sequence mode: the output is the ranluxI_scalar
+  // sequence with the same seed and luxury
+  void initsequence(int seed);
   void nextstate(int nstates);
-  float operator()() {
-    if(unlikely(_pos>=4*24)){_pos = 0; nextstate(_p);}
+  // skip nstates states of every generator, for large nstates via
+  // the equivalent LCG in O(log(nstates)) modular multiplications,
+  // in the sequence mode skip nstates states of the sequence as
+  // ranluxI_scalar::jump does
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
+  float operator()(){
+    if(_seq){
+      // walk through the segment of a generator with the stride 4,
+      // then continue with the segment of the next generator
+      if(unlikely(_pos>=4*24*_nblk)){
+	_pos -= 4*24*_nblk - 1;
+	if(unlikely(_pos>=4)){_pos = 0; nextsequence();}
+      }
+      int i = _pos; _pos += 4;
+      return ((int32_t*)_sb->y)[i]*(1.0f/0x1p24f);
+    }
+    if(unlikely(_pos>=4*24)){_pos = 0; nextstate(_p); countrefill((uint64_t)4*(_p - 1)*RANLUX_STATE_BITS);}
     return ((int32_t*)_x)[_pos++]*(1.0f/0x1p24f);
   }
   //It returns 4x18 uint32
@@ -101,19 +252,65 @@ public:
 };
 
 #ifdef __AVX2__
-class ranluxI_AVX {
+class ranluxI_AVX : public ranluxcounted {
 protected:
   __m256i _x[24]; // state vector - 8 parallel states with 32 bits, only lower 24 bits are random
   __m256i _c;     // carry bits
   int _p;         // number of states to skip
-  int _pos;       // current position in the state vector
+  int _pos;       // current position in the state vector (in the buffer in the sequence mode)
+  bool _seq;      // the generators deliver consecutive blocks of one sequence
+
+  // In the sequence mode every generator produces a segment of _nblk
+  // consecutive blocks of the ranluxI_scalar sequence, the segments of
+  // the generators follow each other. The blocks are buffered and then
+  // the generators jump over the segments of the others via the LCG.
+  static const int _nblk = 32;
+  struct seqbuffer {
+    __m256i y[24*_nblk]; // buffered blocks of all generators
+    __m256i cy[_nblk];   // carry bits of the buffered blocks
+    uint64_t A[9];       // LCG multiplier to the next segment of a generator
+  };
+  // allocated by the sequence mode only, released by init
+  std::unique_ptr<seqbuffer> _sb;
+
+  // continue the scalar sequence from its block x0, c0 with pos numbers
+  // of the block already delivered
+  void setsequence(const uint32_t *x0, uint32_t c0, int pos);
+  // fill the buffer and move the generators to their next segments
+  void nextsequence();
+  // the state of the current block of the sequence and the number of
+  // its delivered numbers
+  void getblock(uint32_t *x, uint32_t &c, int &pos) const;
 public:
   ranluxI_AVX(int seed):ranluxI_AVX(seed,17){};
   ranluxI_AVX(int seed, int lux);
   void init(int seed, bool sameseed=0);
+  // switch to the sequence mode: the output is the ranluxI_scalar
+  // sequence with the same seed and luxury
+  void initsequence(int seed);
   void nextstate(int nstates);
+  // skip nstates states of every generator, for large nstates via
+  // the equivalent LCG in O(log(nstates)) modular multiplications,
+  // in the sequence mode skip nstates states of the sequence as
+  // ranluxI_scalar::jump does
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
   float operator()(){
-    if(unlikely(_pos>=8*24)){_pos = 0; nextstate(_p);}
+    if(_seq){
+      // walk through the segment of a generator with the stride 8,
+      // then continue with the segment of the next generator
+      if(unlikely(_pos>=8*24*_nblk)){
+	_pos -= 8*24*_nblk - 1;
+	if(unlikely(_pos>=8)){_pos = 0; nextsequence();}
+      }
+      int i = _pos; _pos += 8;
+      return ((int32_t*)_sb->y)[i]*(1.0f/0x1p24f);
+    }
+    if(unlikely(_pos>=8*24)){_pos = 0; nextstate(_p); countrefill((uint64_t)8*(_p - 1)*RANLUX_STATE_BITS);}
     return ((int32_t*)_x)[_pos++]*(1.0f/0x1p24f);
   }
   //It returns 8x18 uint32
@@ -133,6 +330,85 @@ public:
 };
 #endif
 
+#ifdef __AVX512F__
+class ranluxI_AVX512 : public ranluxcounted {
+protected:
+  __m512i _x[24]; // state vector - 16 parallel states with 32 bits, only lower 24 bits are random
+  __m512i _c;     // carry bits
+  int _p;         // number of states to skip
+  int _pos;       // current position in the state vector (in the buffer in the sequence mode)
+  bool _seq;      // the generators deliver consecutive blocks of one sequence
+
+  // In the sequence mode every generator produces a segment of _nblk
+  // consecutive blocks of the ranluxI_scalar sequence, the segments of
+  // the generators follow each other. The blocks are buffered and then
+  // the generators jump over the segments of the others via the LCG.
+  static const int _nblk = 32;
+  struct seqbuffer {
+    __m512i y[24*_nblk]; // buffered blocks of all generators
+    __m512i cy[_nblk];   // carry bits of the buffered blocks
+    uint64_t A[9];       // LCG multiplier to the next segment of a generator
+  };
+  // allocated by the sequence mode only, released by init
+  std::unique_ptr<seqbuffer> _sb;
+
+  // continue the scalar sequence from its block x0, c0 with pos numbers
+  // of the block already delivered
+  void setsequence(const uint32_t *x0, uint32_t c0, int pos);
+  // fill the buffer and move the generators to their next segments
+  void nextsequence();
+  // the state of the current block of the sequence and the number of
+  // its delivered numbers
+  void getblock(uint32_t *x, uint32_t &c, int &pos) const;
+public:
+  ranluxI_AVX512(int seed):ranluxI_AVX512(seed,17){};
+  ranluxI_AVX512(int seed, int lux);
+  void init(int seed, bool sameseed=0);
+  // switch to the sequence mode: the output is the ranluxI_scalar
+  // sequence with the same seed and luxury
+  void initsequence(int seed);
+  void nextstate(int nstates);
+  // skip nstates states of every generator, for large nstates via
+  // the equivalent LCG in O(log(nstates)) modular multiplications,
+  // in the sequence mode skip nstates states of the sequence as
+  // ranluxI_scalar::jump does
+  void jump(uint64_t nstates);
+  // binary checkpoint (see ranluxI_checkpoint): save returns its size
+  // in bytes and only computes it for buf = NULL, load returns false
+  // for a checkpoint of an incompatible generator
+  size_t save(void *buf) const;
+  bool load(const void *buf, size_t size);
+  float operator()(){
+    if(_seq){
+      // walk through the segment of a generator with the stride 16,
+      // then continue with the segment of the next generator
+      if(unlikely(_pos>=16*24*_nblk)){
+	_pos -= 16*24*_nblk - 1;
+	if(unlikely(_pos>=16)){_pos = 0; nextsequence();}
+      }
+      int i = _pos; _pos += 16;
+      return ((int32_t*)_sb->y)[i]*(1.0f/0x1p24f);
+    }
+    if(unlikely(_pos>=16*24)){_pos = 0; nextstate(_p); countrefill((uint64_t)16*(_p - 1)*RANLUX_STATE_BITS);}
+    return ((int32_t*)_x)[_pos++]*(1.0f/0x1p24f);
+  }
+  //It returns 16x18 uint32
+  void nextstate_and_get_uint32_vector(uint32_t *x){
+    int j;
+    nextstate(_p);
+    j=0;
+    int32_t* _y;
+    _y = (int32_t*)_x;
+    for(int i=0;i<16*18;i+=3) {
+      x[i]   = (_y[j]<<8)    | (_y[j+1]>>16);
+      x[i+1] = (_y[j+1]<<16) | (_y[j+2]>>8);
+      x[i+2] = (_y[j+2]<<24) | (_y[j+3]);
+      j+=4;
+    }
+  }
+};
+#endif
+
 // For testing purpose, full emulation of the original FORTRAN routine
 // using the optimized subtract-with-borrow algorithm
 // to compare it with the code:
@@ -177,6 +453,7 @@ protected:
   uint64_t _kount; // total generated numbers
 
   float tofloat(int);
+  void tofloats(float*); // convert the whole sequence in the delivery order
   int nextpos(); // next position in the state vector
   void skip(); // skip nskip numbers
   void setlux(int luxury);
@@ -0,0 +1,99 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * The RANLUX generator with the fastest engine for the given luxury.    *
+ * The cost of the conventional subtract-with-borrow skipping grows      *
+ * linearly with the number of skipped states p while the LCG advances   *
+ * the state by one modular multiplication for any p. The engine is      *
+ * chosen at construction from the cost model of the current CPU, the    *
+ * delivered sequence is the ranluxI_scalar one for any engine.          *
+ *************************************************************************/
+
+#include "ranlux.h"
+
+#pragma once
+
+// T = float  -- the 24-bit numbers of ranluxI_scalar
+// T = double -- the pairs of the consecutive 24-bit numbers as 48-bit ones
+template<typename T>
+class ranluxI_auto {
+public:
+  enum { SCALAR, SCALAR48, SSE, AVX, LCG, NBACKENDS };
+protected:
+  int _backend;
+  ranluxI_scalar *_scalar;
+  ranluxI48_scalar *_scalar48;
+  ranluxI_SSE *_sse;
+#ifdef __AVX2__
+  ranluxI_AVX *_avx;
+#endif
+  // the LCG engine
+  ranluxpp *_lcg;
+  uint32_t _y[24]; // RANLUX sequence of the current LCG state
+  int _pos;        // current position in the sequence
+
+  void nextlcg(); // advance the LCG and unpack the sequence
+  float next24(){
+    switch(_backend){
+    case SCALAR: return (*_scalar)();
+    case SSE: return (*_sse)();
+#ifdef __AVX2__
+    case AVX: return (*_avx)();
+#endif
+    default:
+      if(unlikely(_pos>=24)) nextlcg();
+      return (int32_t)_y[_pos++]*(1.0f/0x1p24f);
+    }
+  }
+public:
+  // seed and p as for ranluxI_scalar, backend -- the engine to use
+  // or -1 to take the cheapest one of the cost model
+  ranluxI_auto(int seed, int p = 17, int backend = -1);
+  ranluxI_auto(const ranluxI_auto&) = delete;
+  ranluxI_auto& operator=(const ranluxI_auto&) = delete;
+  ~ranluxI_auto();
+
+  T operator()(){
+    if(sizeof(T) == sizeof(float)) return next24();
+    if(_backend == SCALAR48) return (*_scalar48)();
+    double hi = next24(), lo = next24();
+    return hi + lo*(1.0/0x1p24);
+  }
+
+  int getbackend() const { return _backend; }
+
+  // the instrumentation counters of the engine in use (see ranluxstats.h)
+  ranluxstats getstats() const;
+  static const char *backendname(int backend);
+
+  // the cost model: ns per 24-bit number = slope*p + offset
+  // taken from the calibration table for the current CPU architecture,
+  // measured once on the first use (about 0.1 s) for a CPU not in it
+  static double cost(int backend, int p);
+
+  // cheapest engine for p states to skip
+  static int select(int p);
+
+  // measure the cost model on the running CPU, it replaces the table
+  // entry for the rest of the program, concurrent constructions are safe
+  static void calibrate();
+};
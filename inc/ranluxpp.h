@@ -34,14 +34,16 @@
  * i.e. a * b mod m = 1                                                  *
  *************************************************************************/
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
+#include "ranluxstats.h"
 
 #pragma once
 
 #define   likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
-class ranluxpp {
+class ranluxpp : public ranluxcounted {
 protected:
   uint64_t _x[9]; // state vector - all 64 bits are random
   uint64_t _A[9]; // multiplier
@@ -49,9 +51,7 @@ protected:
   uint32_t _floats[24];  // cache for single precision numbers
   uint32_t _dpos; // position in cache for doubles
   uint32_t _fpos; // position in cache for floats
-
-  // get a = m - (m-1)/b = 2^576 - 2^552 - 2^240 + 2^216 + 1
-  static const uint64_t *geta();
+  uint64_t _nrefill; // cache refills since the seeding
 
   // fill the cache with float type numbers
   void nextfloats();
@@ -65,6 +65,9 @@ protected:
   // transfrom the binary state vector of LCG to 11 doubles
   void unpackdoubles(double *d);
 public:
+  // get a = m - (m-1)/b = 2^576 - 2^552 - 2^240 + 2^216 + 1
+  static const uint64_t *geta();
+
   // The LCG constructor:
   // seed -- jump to the state x_seed = x_0 * A^(2^96 * seed) mod m
   // p    -- the exponent of to get the multiplier A = a^p mod m
@@ -126,3 +129,13 @@ bool getranluxseq(uint32_t y[24], const uint64_t x[9]);
 
 // transform the RANLUX sequence (24 24-bit numbers) and the carry to the LCG state
 void getlcgstate(uint64_t x[9], const uint32_t y[24], bool k);
+
+// batched transformation of n LCG states x[9*n] to RANLUX sequences
+// y[24*n] and carries k[n]; with AVX2 eight states at a time go through
+// one interleaved division, about twice as fast as single transformations
+void getranluxseq(uint32_t *y, bool *k, const uint64_t *x, size_t n);
+
+// batched transformation of n RANLUX sequences y[24*n] and carries k[n]
+// to LCG states x[9*n]; a convenience with the packing vectorized, about
+// 10% faster than the loop of single transformations
+void getlcgstate(uint64_t *x, const uint32_t *y, const bool *k, size_t n);
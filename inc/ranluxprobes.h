@@ -0,0 +1,87 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * USDT (SystemTap/DTrace style) static probes of the provider "ranlux"  *
+ * for bpftrace, perf and stap. Every probe has a semaphore: until a     *
+ * tracer attaches, a probe is a nop and the only cost of its duration   *
+ * measurement is the test of the semaphore. The arguments are the       *
+ * generator (its address), what it advanced or where it is and the      *
+ * duration in time stamp counter ticks:                                 *
+ *   pp_refill     (id, n, ticks)      ranluxpp float or double cache    *
+ *                                     refill, the n-th since seeding    *
+ *   pp_init       (id, seed, ticks)   ranluxpp seeding                  *
+ *   pp_jump       (id, n, ticks)      ranluxpp jump by n numbers        *
+ *   pp_setskip    (id, p, ticks)      ranluxpp new multiplier a^p       *
+ *   swb_nextstate (id, lanes, nstates, ticks)  ranluxI_* skipping       *
+ *   swb_jump      (id, lanes, nstates, ticks)  ranluxI_* jump           *
+ *   swb_init      (id, lanes, seed, ticks)     ranluxI_* seeding        *
+ * e.g. bpftrace -e 'usdt:./ranlux_test:ranlux:swb_nextstate             *
+ *                   { @ticks = hist(arg3); }'                           *
+ * The probes need <sys/sdt.h> (systemtap-sdt-dev) at compile time, they *
+ * are left out without it or with -DRANLUX_NO_PROBES.                   *
+ *************************************************************************/
+
+#pragma once
+
+#if !defined(RANLUX_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define RANLUX_PROBES 1
+#endif
+#endif
+
+#ifdef RANLUX_PROBES
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#include <stdint.h>
+
+// the time stamp counter
+static inline uint64_t ranlux_probe_clock(){
+  uint32_t lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return (uint64_t)hi<<32 | lo;
+}
+
+// the semaphore of a probe, defined once in the file firing the probe
+#define RANLUX_PROBE_SEMAPHORE(name)					\
+  unsigned short ranlux_##name##_semaphore __attribute__((unused)) __attribute__((section(".probes")))
+
+#define RANLUX_PROBE_ENABLED(name) __builtin_expect(ranlux_##name##_semaphore, 0)
+
+// time the code between the begin and the end of a probe, only if
+// a tracer is attached
+#define RANLUX_PROBE_BEGIN(name)					\
+  uint64_t _probe_##name = RANLUX_PROBE_ENABLED(name) ? ranlux_probe_clock() : 0
+#define RANLUX_PROBE_END2(name, a, b) do {				\
+    if(RANLUX_PROBE_ENABLED(name))					\
+      STAP_PROBE3(ranlux, name, a, b, ranlux_probe_clock() - _probe_##name); \
+  } while(0)
+#define RANLUX_PROBE_END3(name, a, b, c) do {				\
+    if(RANLUX_PROBE_ENABLED(name))					\
+      STAP_PROBE4(ranlux, name, a, b, c, ranlux_probe_clock() - _probe_##name); \
+  } while(0)
+#else
+#define RANLUX_PROBE_SEMAPHORE(name) struct ranlux_##name##_semaphore
+#define RANLUX_PROBE_ENABLED(name) 0
+#define RANLUX_PROBE_BEGIN(name) do {} while(0)
+#define RANLUX_PROBE_END2(name, a, b) do {} while(0)
+#define RANLUX_PROBE_END3(name, a, b, c) do {} while(0)
+#endif
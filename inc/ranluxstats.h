@@ -0,0 +1,127 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Runtime instrumentation counters of the generators. They are compiled *
+ * in with -DRANLUX_STATS ("make STATS=yes"), which changes the layout   *
+ * of the generator classes, so the library and the code using it have   *
+ * to be built with the same setting. Without it the counting compiles   *
+ * to nothing, the counter base of the generators is empty and getstats  *
+ * returns zeros. Every generator keeps its own counters, in addition    *
+ * every thread accumulates the counts of all generators it runs; the    *
+ * totals of all threads, finished ones included, can be taken at any    *
+ * time.                                                                 *
+ *************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#ifdef RANLUX_STATS
+#include <atomic>
+#endif
+
+#pragma once
+
+// bits of the RANLUX state, the 24 24-bit numbers or the LCG state
+#define RANLUX_STATE_BITS 576
+
+struct ranluxstats {
+#ifdef RANLUX_STATS
+  static const bool enabled = true;
+#else
+  static const bool enabled = false;
+#endif
+  uint64_t states = 0;    // states advanced: the multiplications by A of ranluxpp, the subtract-with-
+                          // borrow states of ranluxI_* summed over the parallel generators
+  uint64_t refills = 0;   // refills of the number caches or the state vectors delivering numbers
+  uint64_t jumps = 0;     // jumps ahead and reseedings
+  uint64_t discarded = 0; // random bits produced but never delivered: the 4 bits per unpacked
+                          // state of the ranluxpp doubles, the states ranluxI_* skip for the luxury
+
+  ranluxstats &operator+=(const ranluxstats &a){
+    states += a.states; refills += a.refills; jumps += a.jumps; discarded += a.discarded;
+    return *this;
+  }
+  ranluxstats operator+(const ranluxstats &a) const { ranluxstats r = *this; return r += a; }
+  // the counts between two snapshots
+  ranluxstats operator-(const ranluxstats &a) const {
+    ranluxstats r = *this;
+    r.states -= a.states; r.refills -= a.refills; r.jumps -= a.jumps; r.discarded -= a.discarded;
+    return r;
+  }
+  void print(FILE *stream) const;
+};
+
+// snapshot of the counters of the calling thread
+ranluxstats ranluxstats_thread();
+
+// snapshot of the sum of the counters of all threads
+ranluxstats ranluxstats_total();
+
+#ifdef RANLUX_STATS
+// the counters of a thread, written by the thread only and read by the
+// snapshots of the other threads
+struct ranluxstats_counters {
+  std::atomic<uint64_t> states{0}, refills{0}, jumps{0}, discarded{0};
+};
+
+extern thread_local ranluxstats_counters *ranluxstats_tls;
+
+// register the counters of the calling thread
+ranluxstats_counters *ranluxstats_register();
+
+static inline void ranluxstats_add(std::atomic<uint64_t> &c, uint64_t n){
+  c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#define RANLUX_COUNT(field, n) do {					\
+    uint64_t _count_n = (n);						\
+    ranluxstats_counters *_count_t = ranluxstats_tls;			\
+    if(__builtin_expect(!_count_t, 0)) _count_t = ranluxstats_register(); \
+    _stats.field += _count_n;						\
+    ranluxstats_add(_count_t->field, _count_n);				\
+  } while(0)
+#else
+#define RANLUX_COUNT(field, n) do {} while(0)
+#endif
+
+// the base of the generators holding their counters
+class ranluxcounted {
+#ifdef RANLUX_STATS
+protected:
+  ranluxstats _stats;
+public:
+  // the counters of the generator since its construction or the last reset
+  ranluxstats getstats() const { return _stats; }
+  void resetstats(){ _stats = ranluxstats(); }
+protected:
+  // a refill of the numbers produced with the given number of discarded bits
+  void countrefill(uint64_t bits){
+    RANLUX_COUNT(refills, 1);
+    RANLUX_COUNT(discarded, bits);
+  }
+#else
+public:
+  ranluxstats getstats() const { return ranluxstats(); }
+  void resetstats(){}
+protected:
+  void countrefill(uint64_t){}
+#endif
+};
@@ -0,0 +1,105 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Drop-in replacements of the std::ranlux24 and std::ranlux48 engines   *
+ * producing exactly the same sequences. The underlying subtract-with-   *
+ * carry engines std::ranlux24_base (b = 2^24, r = 24, s = 10) and       *
+ * std::ranlux48_base (b = 2^48, r = 12, s = 5) share the modulus        *
+ * m = 2^576 - 2^240 + 1 of the LCG, so the whole discard_block of p     *
+ * numbers is skipped by one modular multiplication and the used r       *
+ * numbers are unpacked from the LCG state as in getranluxseq.           *
+ *************************************************************************/
+
+#include <stdint.h>
+#include <type_traits>
+#include "ranluxpp.h"
+
+#pragma once
+
+class ranluxstd {
+protected:
+  uint64_t _x[9];    // LCG state, its RANLUX sequence starts with the current block
+  uint64_t _A[9];    // multiplier to the next block A = a^(p*w/24) mod m
+  uint64_t _y[23];   // used numbers of the current block
+  int _w;            // number of bits of the base engine numbers -- 24 or 48
+  int _p;            // block size
+  int _r;            // used numbers per block
+  int _pos;          // position in the current block
+
+  ranluxstd(int w, int p, int r);
+
+  // set the state of the base engine from its long lag x[0] ... x[R-1]
+  // (x[R-1] is the most recent number) and the carry bit
+  void setstate(const uint64_t *x, bool c);
+
+  // set the state of the base engine as std::subtract_with_carry_engine does
+  // from the seed sequence with k = (w+31)/32 words per number
+  void setstate(const uint32_t *a);
+
+  // advance to the next block and unpack it
+  void nextblock();
+
+  // unpack the used numbers of the current block
+  void unpack();
+public:
+  // seed as the base std::subtract_with_carry_engine::seed(value) does
+  void seed(uint64_t value);
+
+  // advance the engine by z numbers
+  void discard(unsigned long long z);
+};
+
+template<class UIntType, int w, int p, int r, int base_r>
+class ranluxstd_engine : public ranluxstd {
+public:
+  typedef UIntType result_type;
+  static constexpr size_t block_size = p;
+  static constexpr size_t used_block = r;
+  static constexpr result_type default_seed = 19780503u;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return (((uint64_t)1)<<w) - 1; }
+
+  ranluxstd_engine() : ranluxstd_engine(default_seed) {}
+  explicit ranluxstd_engine(result_type value) : ranluxstd(w, p, r) { seed(value); }
+  template<class Sseq, class = typename std::enable_if<
+			 !std::is_convertible<Sseq, result_type>::value>::type>
+  explicit ranluxstd_engine(Sseq &q) : ranluxstd(w, p, r) { seed(q); }
+
+  void seed() { seed(default_seed); }
+  void seed(result_type value) { ranluxstd::seed(value); }
+  template<class Sseq>
+  typename std::enable_if<!std::is_convertible<Sseq, result_type>::value>::type
+  seed(Sseq &q) {
+    uint32_t a[base_r*((w+31)/32)];
+    q.generate(a, a + base_r*((w+31)/32));
+    setstate(a);
+  }
+
+  result_type operator()() {
+    if(unlikely(_pos >= r)) nextblock();
+    return _y[_pos++];
+  }
+};
+
+// the same sequences as std::ranlux24 and std::ranlux48
+typedef ranluxstd_engine<uint_fast32_t, 24, 223, 23, 24> ranlux24pp;
+typedef ranluxstd_engine<uint_fast64_t, 48, 389, 11, 12> ranlux48pp;
@@ -0,0 +1,366 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Generic equivalence between the subtract-with-borrow generator        *
+ * x_n = x_{n-s} - x_{n-r} - c_{n-1} mod b, b = 2^w                      *
+ * and the Linear Congruential Generator x_{i+1} = a * x_i mod m with    *
+ * the modulus m = b^r - b^s + 1 and the multiplier a = m - (m-1)/b, the *
+ * multiplicative inverse of the base b. The SWB sequence is the         *
+ * fractional expansion of x/m in base b. The modulus, the multiplier,   *
+ * the modular arithmetic and the state conversions are derived from     *
+ * (w, r, s) at compile time. The modulus shape of RANLUX++              *
+ * m = 2^576 - 2^240 + 1 (std::ranlux24_base and std::ranlux48_base) is  *
+ * served by the asm kernels, all others by portable code.               *
+ *************************************************************************/
+
+#include <stdint.h>
+#include "ranluxpp.h"
+#include "mulmod.h"
+
+#pragma once
+
+// multiple precision helpers on little-endian arrays of 64-bit limbs
+namespace swblcg_detail {
+  // z += x, returns carry
+  static inline bool add(uint64_t *z, const uint64_t *x, int n){
+    unsigned char c = 0;
+    for(int i=0;i<n;i++){
+      unsigned long long t;
+      c = __builtin_ia32_addcarryx_u64(c, z[i], x[i], &t);
+      z[i] = t;
+    }
+    return c;
+  }
+
+  // z -= x, returns borrow
+  static inline bool sub(uint64_t *z, const uint64_t *x, int n){
+    unsigned char c = 0;
+    for(int i=0;i<n;i++){
+      unsigned long long t;
+      c = __builtin_ia32_sbb_u64(c, z[i], x[i], &t);
+      z[i] = t;
+    }
+    return c;
+  }
+
+  // compare x and y
+  static inline int cmp(const uint64_t *x, const uint64_t *y, int n){
+    for(int i=n-1;i>=0;i--)
+      if(x[i] != y[i]) return (x[i] > y[i]) ? 1 : -1;
+    return 0;
+  }
+
+  static inline bool iszero(const uint64_t *x, int n){
+    for(int i=0;i<n;i++) if(x[i]) return false;
+    return true;
+  }
+
+  // z[nz] = x[nx] << sh (bits), z and x must not overlap
+  static inline void shl(uint64_t *z, int nz, const uint64_t *x, int nx, int sh){
+    int q = sh/64, b = sh%64;
+    for(int i=0;i<nz;i++){
+      int j = i - q;
+      uint64_t lo = (j >= 0 && j < nx) ? x[j] : 0;
+      uint64_t hi = (j-1 >= 0 && j-1 < nx) ? x[j-1] : 0;
+      z[i] = b ? (lo<<b | hi>>(64-b)) : lo;
+    }
+  }
+
+  // z[nz] = x[nx] >> sh (bits), z and x must not overlap
+  static inline void shr(uint64_t *z, int nz, const uint64_t *x, int nx, int sh){
+    int q = sh/64, b = sh%64;
+    for(int i=0;i<nz;i++){
+      int j = i + q;
+      uint64_t lo = (j < nx) ? x[j] : 0;
+      uint64_t hi = (j+1 < nx) ? x[j+1] : 0;
+      z[i] = b ? (lo>>b | hi<<(64-b)) : lo;
+    }
+  }
+
+  // keep the lower nbits bits of x[n]
+  static inline void mask(uint64_t *x, int n, int nbits){
+    for(int i=0;i<n;i++){
+      if(64*i >= nbits) x[i] = 0;
+      else if(64*(i+1) > nbits) x[i] &= (~(uint64_t)0)>>(64*(i+1) - nbits);
+    }
+  }
+
+  // nbits bits of x starting from the bit pos, nbits <= 64
+  static inline uint64_t getbits(const uint64_t *x, int pos, int nbits){
+    int q = pos/64, b = pos%64;
+    uint64_t v = x[q]>>b;
+    if(b && b + nbits > 64) v |= x[q+1]<<(64-b);
+    return (nbits<64) ? v & ((((uint64_t)1)<<nbits) - 1) : v;
+  }
+
+  // set nbits bits of x starting from the bit pos to v, the bits must be zero
+  static inline void setbits(uint64_t *x, int pos, int nbits, uint64_t v){
+    int q = pos/64, b = pos%64;
+    x[q] |= v<<b;
+    if(b && b + nbits > 64) x[q+1] |= v>>(64-b);
+  }
+
+  // z[nx+ny] = x[nx] * y[ny] by the schoolbook method
+  static inline void mul(uint64_t *z, const uint64_t *x, int nx, const uint64_t *y, int ny){
+    for(int i=0;i<nx+ny;i++) z[i] = 0;
+    for(int i=0;i<nx;i++){
+      uint64_t c = 0;
+      for(int j=0;j<ny;j++){
+	unsigned __int128 t = (unsigned __int128)x[i]*y[j] + z[i+j] + c;
+	z[i+j] = t;
+	c = t>>64;
+      }
+      z[i+ny] = c;
+    }
+  }
+}
+
+template<int w, int r, int s>
+class swblcg {
+  static_assert(0 < w && w <= 64, "the base has to be 2^w with 0 < w <= 64");
+  static_assert(0 < s && s < r, "the lags have to satisfy 0 < s < r");
+public:
+  static constexpr int nbits = w*r; // the modulus is below 2^nbits
+  static constexpr int nlimbs = (nbits + 63)/64;
+
+  // m = 2^576 - 2^240 + 1 is served by the asm kernels of RANLUX++
+  static constexpr bool ranluxshape = nbits == 576 && w*s == 240;
+
+  // the modulus m = b^r - b^s + 1
+  static const uint64_t *modulus(){ return tables().m; }
+
+  // the multiplier a = m - (m-1)/b, the multiplicative inverse of b
+  static const uint64_t *geta(){ return tables().a; }
+
+  // x <- x * y mod m
+  static void mulmod(uint64_t *x, const uint64_t *y){
+    if constexpr (ranluxshape) ::mul9x9mod(x, y);
+    else mulmod_generic(x, y);
+  }
+
+  // x <- x^n mod m
+  static void powmod(uint64_t *x, uint64_t n){
+    if constexpr (ranluxshape) { ::powmod(x, n); return; }
+    uint64_t res[nlimbs] = {1};
+    while(n){
+      if(n&1) mulmod(res, x);
+      n >>= 1;
+      if(!n) break;
+      mulmod(x, x);
+    }
+    for(int i=0;i<nlimbs;i++) x[i] = res[i];
+  }
+
+  // the multiplier A = a^n mod m to skip n numbers of the SWB sequence
+  static void getmultiplier(uint64_t *A, uint64_t n){
+    for(int i=0;i<nlimbs;i++) A[i] = geta()[i];
+    powmod(A, n);
+  }
+
+  // transform the SWB sequence y[0] (the most recent) ... y[r-1] and
+  // the carry to the LCG state x
+  static void getlcgstate(uint64_t *x, const uint64_t *y, bool c){
+    if constexpr (ranluxshape && (w == 24 || w == 48)) {
+      uint32_t y24[24];
+      for(int i=0;i<r;i++){
+	if(w == 24){
+	  y24[i] = y[i];
+	} else {
+	  y24[2*i] = y[i]>>24; y24[2*i+1] = y[i] & 0xffffff;
+	}
+      }
+      ::getlcgstate(x, y24, c);
+    } else {
+      getlcgstate_generic(x, y, c);
+    }
+  }
+
+  // transform the LCG state x to the SWB sequence y[0] (the most recent)
+  // ... y[r-1], returns carry
+  static bool getswbseq(uint64_t *y, const uint64_t *x){
+    if constexpr (ranluxshape && (w == 24 || w == 48)) {
+      uint32_t y24[24];
+      bool c = ::getranluxseq(y24, x);
+      for(int i=0;i<r;i++)
+	y[i] = (w == 24) ? y24[i] : ((uint64_t)y24[2*i]<<24 | y24[2*i+1]);
+      return c;
+    } else {
+      return getswbseq_generic(y, x);
+    }
+  }
+
+  // portable versions, available for any parameters to cross-check the
+  // specialized ones
+
+  // x <- x * y mod m
+  static void mulmod_generic(uint64_t *x, const uint64_t *y){
+    uint64_t t[2*nlimbs+1];
+    swblcg_detail::mul(t, x, nlimbs, y, nlimbs);
+    t[2*nlimbs] = 0;
+    reduce(t, 2*nlimbs+1);
+    for(int i=0;i<nlimbs;i++) x[i] = t[i];
+  }
+
+  // x = Y - floor(Y/b^(r-s)) + c, where Y = 0.(y0 y1 ... y{r-1}) * b^r
+  static void getlcgstate_generic(uint64_t *x, const uint64_t *y, bool c){
+    using namespace swblcg_detail;
+    uint64_t Y[nlimbs+1] = {0}, Yh[nlimbs+1], one[nlimbs+1] = {c};
+    for(int i=0;i<r;i++) setbits(Y, w*(r-1-i), w, y[i]);
+    shr(Yh, nlimbs+1, Y, nlimbs+1, w*(r-s));
+    add(Y, one, nlimbs+1);
+    sub(Y, Yh, nlimbs+1);
+    reduce(Y, nlimbs+1);
+    for(int i=0;i<nlimbs;i++) x[i] = Y[i];
+  }
+
+  // the first r+1 digits of x/m in base b via the Barrett division
+  // q = floor(x * b^(r+1) / m), the extra digit gives the carry
+  static bool getswbseq_generic(uint64_t *y, const uint64_t *x){
+    using namespace swblcg_detail;
+    const tables_t &T = tables();
+    uint64_t xm[nlimbs + nmu], q[nq+1], N[nK+1], qm[nq+1+nlimbs];
+    mul(xm, x, nlimbs, T.mu, nmu);
+    shr(q, nq+1, xm, nlimbs + nmu, nbits);
+    shl(N, nK+1, x, nlimbs, w*(r+1));
+    mul(qm, q, nq+1, T.m, nlimbs);
+    sub(N, qm, nK+1);                                 // N - q*m < 3m
+    uint64_t one[nq+1] = {1};
+    while(cmp(N, T.m1, nK+1) >= 0){ sub(N, T.m1, nK+1); add(q, one, nq+1); }
+
+    for(int i=0;i<r;i++) y[i] = getbits(q, w*(r-i), w);
+    uint64_t yr = getbits(q, 0, w);                   // the digit before y[r-1]
+    const __int128 mb = (((__int128)1)<<w) - 1;
+    __int128 d = (__int128)yr - y[s];
+    bool c0 = ((d + y[0] + 1) & mb) == 0;
+    return d + c0 > 0;
+  }
+private:
+  static constexpr int nK  = (w*(2*r+1) + 63)/64 + 1;       // limbs of x * b^(r+1)
+  static constexpr int nmu = (w*(r+1) + 1 + 63)/64 + 1;     // limbs of the reciprocal
+  static constexpr int nq  = (w*(r+1) + 63)/64 + 1;         // limbs of the quotient
+
+  struct tables_t {
+    uint64_t m[nlimbs];  // modulus
+    uint64_t m1[nK+1];   // modulus padded to the length of the Barrett numerator
+    uint64_t a[nlimbs];  // multiplier
+    uint64_t mu[nmu];    // the reciprocal floor(2^(w(2r+1))/m)
+    tables_t(){
+      using namespace swblcg_detail;
+      // m = 2^nbits - 2^(ws) + 1
+      for(int i=0;i<nlimbs;i++) m[i] = 0;
+      for(int i=w*s;i<nbits;i++) m[i/64] |= ((uint64_t)1)<<(i%64);
+      m[0] |= 1;
+      for(int i=0;i<nK+1;i++) m1[i] = (i<nlimbs) ? m[i] : 0;
+
+      // a = m - (m-1)/b, (m-1)/b = 2^(nbits-w) - 2^(ws-w)
+      uint64_t d[nlimbs] = {0};
+      for(int i=w*s-w;i<nbits-w;i++) d[i/64] |= ((uint64_t)1)<<(i%64);
+      for(int i=0;i<nlimbs;i++) a[i] = m[i];
+      sub(a, d, nlimbs);
+
+      // long division of 2^K by m bit by bit
+      const int K = w*(2*r+1);
+      uint64_t rem[nlimbs+1] = {0}, mm[nlimbs+1];
+      for(int i=0;i<nlimbs+1;i++) mm[i] = (i<nlimbs) ? m[i] : 0;
+      for(int i=0;i<nmu;i++) mu[i] = 0;
+      for(int i=K;i>=0;i--){
+	uint64_t t[nlimbs+1];
+	shl(t, nlimbs+1, rem, nlimbs+1, 1);
+	if(i == K) t[0] |= 1;
+	for(int j=0;j<nlimbs+1;j++) rem[j] = t[j];
+	if(cmp(rem, mm, nlimbs+1) >= 0){
+	  sub(rem, mm, nlimbs+1);
+	  mu[i/64] |= ((uint64_t)1)<<(i%64);
+	}
+      }
+    }
+  };
+
+  static const tables_t &tables(){
+    static const tables_t t;
+    return t;
+  }
+
+  // t[n] <- t mod m by folding 2^nbits = 2^(ws) - 1 mod m, n <= 2*nlimbs+1
+  static void reduce(uint64_t *t, int n){
+    using namespace swblcg_detail;
+    uint64_t h[2*nlimbs+1], hs[2*nlimbs+1];
+    for(;;){
+      shr(h, n, t, n, nbits);
+      if(iszero(h, n)) break;
+      mask(t, n, nbits);
+      shl(hs, n, h, n, w*s);
+      add(t, hs, n);  // t + h*2^(ws) - h >= 0
+      sub(t, h, n);
+    }
+    while(cmp(t, modulus(), nlimbs) >= 0) sub(t, modulus(), nlimbs);
+  }
+};
+
+// The subtract-with-borrow generator with luxury: after each r numbers
+// of the sequence p - r numbers are skipped, p >= r, by the modular
+// multiplication of the equivalent LCG. The numbers are w-bit integers.
+template<int w, int r, int s>
+class swblcg_engine {
+protected:
+  typedef swblcg<w,r,s> lcg;
+  uint64_t _x[lcg::nlimbs]; // LCG state, its sequence is the current block
+  uint64_t _A[lcg::nlimbs]; // multiplier to the next block A = a^p mod m
+  uint64_t _y[r];           // current block, the most recent number first
+  int _pos;                 // numbers left in the current block
+
+  void nextblock(){
+    lcg::mulmod(_x, _A);
+    lcg::getswbseq(_y, _x);
+    _pos = r;
+  }
+public:
+  typedef uint64_t result_type;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return (w<64) ? (((uint64_t)1)<<(w%64)) - 1 : ~(uint64_t)0; }
+
+  swblcg_engine(uint64_t p = r) : _pos(0) {
+    lcg::getmultiplier(_A, p);
+    for(int i=0;i<lcg::nlimbs;i++) _x[i] = (i==0);
+  }
+
+  // get access to the LCG state
+  uint64_t *getstate() { return _x; }
+
+  // set the state of the generator from the long lag x[0] (the oldest)
+  // ... x[r-1] (the most recent) and the carry bit, the next block
+  // starts with the number following x[r-1]
+  void setstate(const uint64_t *x, bool c){
+    uint64_t y[r], a[lcg::nlimbs];
+    for(int i=0;i<r;i++) y[i] = x[r-1-i];
+    lcg::getlcgstate(_x, y, c);
+    lcg::getmultiplier(a, r);
+    lcg::mulmod(_x, a);
+    lcg::getswbseq(_y, _x);
+    _pos = r;
+  }
+
+  result_type operator()(){
+    if(unlikely(_pos <= 0)) nextblock();
+    return _y[--_pos];
+  }
+};
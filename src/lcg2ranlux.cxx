@@ -21,6 +21,11 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stddef.h>
+#include "ranluxpp.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 extern "C" {
   // the first 18 limbs of the fractional exansion of
@@ -123,3 +128,150 @@ void getlcgstate(uint64_t x[9], const uint32_t y[24], bool k){
     k = a < k;
   } while(k && ++i<9);
 }
+
+#ifdef __AVX2__
+// pack 24 24-bit numbers into the 576-bit number
+// Y = y[0]*2^552 + y[1]*2^528 + ... + y[23], Y has to be writable
+// 8 bytes beyond Y[8]
+static inline void pack2ranluxseq_avx2(uint64_t Y[9], const uint32_t y[24]){
+  uint8_t *b = (uint8_t*)Y;
+  const __m256i gather = _mm256_setr_epi32(0,1,2,4,5,6,7,7),
+    rev = _mm256_setr_epi32(7,6,5,4,3,2,1,0),
+    shuf = _mm256_setr_epi8(0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1,
+			    0,1,2, 4,5,6, 8,9,10, 12,13,14, -1,-1,-1,-1);
+  for(int g=0;g<3;g++){
+    __m256i v = _mm256_loadu_si256((const __m256i*)(y + 16 - 8*g));
+    v = _mm256_permutevar8x32_epi32(v, rev);
+    v = _mm256_shuffle_epi8(v, shuf);
+    v = _mm256_permutevar8x32_epi32(v, gather);
+    _mm256_storeu_si256((__m256i*)(b + 24*g), v);
+  }
+}
+
+// transpose the 8x8 matrix of 32-bit words in the rows r[0..7]
+static inline void transpose8x8_avx2(__m256i r[8]){
+  __m256i t[8], u[8];
+  for(int i=0;i<4;i++){
+    t[2*i] = _mm256_unpacklo_epi32(r[2*i], r[2*i+1]);
+    t[2*i+1] = _mm256_unpackhi_epi32(r[2*i], r[2*i+1]);
+  }
+  for(int i=0;i<2;i++){
+    u[4*i] = _mm256_unpacklo_epi64(t[4*i], t[4*i+2]);
+    u[4*i+1] = _mm256_unpackhi_epi64(t[4*i], t[4*i+2]);
+    u[4*i+2] = _mm256_unpacklo_epi64(t[4*i+1], t[4*i+3]);
+    u[4*i+3] = _mm256_unpackhi_epi64(t[4*i+1], t[4*i+3]);
+  }
+  for(int i=0;i<4;i++){
+    r[i] = _mm256_permute2x128_si256(u[i], u[i+4], 0x20);
+    r[i+4] = _mm256_permute2x128_si256(u[i], u[i+4], 0x31);
+  }
+}
+
+// _divmult of 8 LCG states x[9*8] at once, the lane j of the vectors
+// is the state j. The states are split into 24 24-bit digits X[i], all
+// terms of the reciprocal are shifts by whole digits:
+//   y = x*2^576 + x*2^240 - x + x>>96 - 2*(x>>336) - bit335 + x>>432
+// the digit sums of y are collected without carries and normalized in
+// one pass from the lowest digit. The digits 23 ... 47 of y, i.e. the
+// 48 upper bits of b[8] and b[9 ... 17] of _divmult, are stored to
+// d[0 ... 24].
+static void divmult8_avx2(__m256i d[25], const uint64_t *x){
+  const __m256i spread = _mm256_setr_epi32(0,1,2,3,3,4,5,6),
+    spread2 = _mm256_setr_epi32(2,3,4,4,5,6,7,7),
+    shuf = _mm256_setr_epi8(0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1,
+			    0,1,2,-1, 3,4,5,-1, 6,7,8,-1, 9,10,11,-1),
+    mask = _mm256_set1_epi32((1<<24)-1), zero = _mm256_setzero_si256();
+  __m256i X[24];
+  for(int g=0;g<3;g++){
+    // digits 8g ... 8g+7 of the states, the last group is loaded 8 bytes
+    // early not to read beyond the state
+    __m256i *v = X + 8*g;
+    for(int j=0;j<8;j++){
+      const uint8_t *b = (const uint8_t*)(x + 9*j) + 24*g;
+      if(g < 2)
+	v[j] = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)b), spread);
+      else
+	v[j] = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(b - 8)), spread2);
+      v[j] = _mm256_shuffle_epi8(v[j], shuf);
+    }
+    transpose8x8_avx2(v);
+  }
+  auto digit = [&X, zero](int i){ return (i >= 0 && i < 24) ? X[i] : zero; };
+  __m256i c = _mm256_sub_epi32(zero, _mm256_srli_epi32(X[13], 23)); // -bit335
+  for(int k=0;k<48;k++){
+    __m256i t = _mm256_add_epi32(digit(k-24), digit(k-10));
+    t = _mm256_add_epi32(t, _mm256_add_epi32(digit(k+4), digit(k+18)));
+    t = _mm256_sub_epi32(t, _mm256_add_epi32(digit(k), _mm256_slli_epi32(digit(k+14), 1)));
+    t = _mm256_add_epi32(t, c);
+    c = _mm256_srai_epi32(t, 24);
+    if(k >= 23) d[k-23] = _mm256_and_si256(t, mask);
+  }
+}
+#endif
+
+// batched transformation of n LCG states x[9*n] to RANLUX sequences
+// y[24*n] and carries k[n]
+void getranluxseq(uint32_t *y, bool *k, const uint64_t *x, size_t n){
+  const int mask = (1<<24)-1;
+  size_t i0 = 0;
+#ifdef __AVX2__
+  // eight states at a time through the interleaved division, the digits
+  // 47 ... 24 are the RANLUX sequence y[0 ... 23] of every state
+  for(;i0+8<=n;i0+=8){
+    __m256i d[25], *r = d + 1;
+    divmult8_avx2(d, x + 9*i0);
+    __m256i s[3][8];
+    for(int g=0;g<3;g++){
+      for(int i=0;i<8;i++) s[g][i] = r[23-8*g-i];
+      transpose8x8_avx2(s[g]);
+    }
+    for(int j=0;j<8;j++)
+      for(int g=0;g<3;g++) _mm256_storeu_si256((__m256i*)(y + 24*(i0+j) + 8*g), s[g][j]);
+    // the carries as in the single state transformation
+    __m256i dd = _mm256_sub_epi32(d[0], r[13]);
+    __m256i c0 = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_add_epi32(_mm256_add_epi32(dd, r[23]),
+									  _mm256_set1_epi32(1)),
+							 _mm256_set1_epi32(mask)), _mm256_setzero_si256());
+    __m256i c1 = _mm256_cmpgt_epi32(_mm256_sub_epi32(dd, c0), _mm256_setzero_si256());
+    int m = _mm256_movemask_ps(_mm256_castsi256_ps(c1));
+    for(int j=0;j<8;j++) k[i0+j] = (m>>j)&1;
+  }
+#endif
+  // the rest one state at a time
+  uint64_t zxz[1+9+1], b[18+2];
+  zxz[0] = zxz[10] = 0;
+  for(;i0<n;i0++){
+    for(int i=0;i<9;i++) zxz[i+1] = x[9*i0 + i];
+    _divmult(b, zxz+1);
+    uint32_t *yj = y + 24*i0;
+    unpack2ranluxseq(yj, b);
+    int y24 = b[8]>>(64-24);
+    int d = y24 - yj[10];
+    bool c0 = ((d + yj[0] + 1)&mask) == 0;
+    k[i0] = d + c0 > 0;
+  }
+}
+
+// batched transformation of n RANLUX sequences y[24*n] and carries k[n]
+// to LCG states x[9*n]
+void getlcgstate(uint64_t *x, const uint32_t *y, const bool *k, size_t n){
+#ifdef __AVX2__
+  for(size_t j=0;j<n;j++){
+    uint64_t Y[9+1], *xj = x + 9*j;
+    pack2ranluxseq_avx2(Y, y + 24*j);
+
+    // x = Y + k - (Y >> 336)
+    uint64_t xm[9] = {Y[6]<<48 | Y[5]>>16, Y[7]<<48 | Y[6]>>16,
+		      Y[8]<<48 | Y[7]>>16, Y[8]>>16};
+    unsigned char c = k[j], bw = 0;
+    for(int i=0;i<9;i++){
+      unsigned long long t;
+      c = __builtin_ia32_addcarryx_u64(c, Y[i], 0, &t);
+      bw = __builtin_ia32_sbb_u64(bw, t, xm[i], &t);
+      xj[i] = t;
+    }
+  }
+#else
+  for(size_t j=0;j<n;j++) getlcgstate(x + 9*j, y + 24*j, k[j]);
+#endif
+}
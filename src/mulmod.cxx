@@ -64,3 +64,18 @@ void mul9x9mod(uint64_t *b, const uint64_t *a) {
   _remainder(buf);
   memcpy(b, buf, sizeof(uint64_t)*9);
 }
+
+// modular exponentiation:
+// x <- x^n mod (2^576 - 2^240 + 1)
+void powmod(uint64_t *x, unsigned long int n){
+  uint64_t res[9];
+  res[0] = 1;
+  for(int i=1;i<9;i++) res[i] = 0;
+  while(n){
+    if(n&1) mul9x9mod(res, x);
+    n >>= 1;
+    if(!n) break;
+    mul9x9mod(x, x);
+  }
+  for(int i=0;i<9;i++) x[i] = res[i];
+}
@@ -20,7 +20,34 @@
  *************************************************************************/
 
 #include "ranlux.h"
+#include "mulmod.h"
+#include "ranluxprobes.h"
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <atomic>
+
+RANLUX_PROBE_SEMAPHORE(swb_nextstate);
+RANLUX_PROBE_SEMAPHORE(swb_jump);
+RANLUX_PROBE_SEMAPHORE(swb_init);
+
+static std::atomic<ranlux_logger> logger(NULL);
+
+ranlux_logger ranlux_setlogger(ranlux_logger f){
+  return logger.exchange(f);
+}
+
+// format the message only if somebody listens
+static void __attribute__((format(printf, 1, 2))) ranlux_log(const char *fmt, ...){
+  ranlux_logger f = logger.load(std::memory_order_relaxed);
+  if(likely(!f)) return;
+  char msg[256];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, ap);
+  va_end(ap);
+  f(msg);
+}
 
 #ifdef ASMSKIP
 extern "C" {
@@ -29,6 +56,12 @@ extern "C" {
   // carry -- carry bit
   // nskip -- how many states to skip 
   unsigned char _skipstates(uint32_t *state, unsigned char carry, uint64_t nskip);
+  // 2 and 4 generators with consecutive state vectors skipped together
+  // carry -- carry bits of the generators
+  void _skipstates2(uint32_t *state, uint32_t *carry, uint64_t nskip);
+  void _skipstates4(uint32_t *state, uint32_t *carry, uint64_t nskip);
+  // the generator with the base 2^48 and the lags r = 12, s = 5
+  unsigned char _skipstates48(uint64_t *state, unsigned char carry, uint64_t nskip);
 };
 #endif
 
@@ -78,22 +111,167 @@ public:
   }
 };
 
+// Skipping via the equivalent LCG costs a modular exponentiation
+// shared by all generators and, per generator, the conversion to the
+// LCG state and back plus one modular multiplication. The costs are
+// expressed in units of the scalar state advance (24 subtract-with-borrow
+// steps), swbcost is the cost of one state advance of the generator.
+static bool lcgjump_is_faster(uint64_t nstates, int nlanes, int swbcost){
+  const int mulcost = 8, convcost = 4;
+  if(nstates < 2) return false; // no exponentiation pays off, clz(0) is undefined
+  if(nstates >= (1UL<<32)) return true;
+  uint64_t e = 24*nstates;
+  int nmul = 64 - __builtin_clzl(e) + __builtin_popcountl(e) + nlanes;
+  return nstates*swbcost > (uint64_t)(nmul*mulcost + nlanes*convcost);
+}
+
+// multiply the LCG states of nlanes (at most 16) interleaved generators by A
+// x[24*nlanes] -- state vectors, x[k*nlanes + lane]
+// c[nlanes]    -- carry bits
+static void lcgmul(uint32_t *x, uint32_t *c, int nlanes, const uint64_t *A){
+  uint64_t s[9*16];
+  uint32_t y[24*16];
+  bool k[16];
+  for(int l=0;l<nlanes;l++){
+    for(int j=0;j<24;j++) y[24*l + j] = x[j*nlanes + l];
+    k[l] = c[l];
+  }
+  getlcgstate(s, y, k, nlanes);
+  for(int l=0;l<nlanes;l++) mul9x9mod(s + 9*l, A);
+  getranluxseq(y, k, s, nlanes);
+  for(int l=0;l<nlanes;l++){
+    for(int j=0;j<24;j++) x[j*nlanes + l] = y[24*l + j];
+    c[l] = k[l];
+  }
+}
+
+// skip nstates states of nlanes interleaved generators
+// via the LCG: x <- x * a^(24*nstates) mod m
+static void lcgjump(uint32_t *x, uint32_t *c, int nlanes, uint64_t nstates){
+  uint64_t A[9];
+  for(int i=0;i<9;i++) A[i] = ranluxpp::geta()[i];
+  if(nstates < (1UL<<59)){
+    powmod(A, 24*nstates);
+  } else {
+    powmod(A, 24); powmod(A, nstates);
+  }
+  lcgmul(x, c, nlanes, A);
+}
+
+// set nlanes interleaved generators to the segments of nblk blocks of
+// p states of the scalar sequence starting from the state x0 and the
+// carry c0: the lane l starts at the state after l*nblk*p states
+// A -- the multiplier moving a lane from the last block of its segment
+//      to the first block of its next segment, (nlanes-1)*nblk+1 blocks
+static void lcgsequence(uint32_t *x, uint32_t *c, int nlanes, int nblk, int p,
+			const uint32_t *x0, uint32_t c0, uint64_t *A){
+  uint64_t B[9], s[9*16];
+  uint32_t y[24*16];
+  bool k[16];
+  for(int i=0;i<9;i++) B[i] = A[i] = ranluxpp::geta()[i];
+  powmod(B, 24UL*p*nblk);
+  powmod(A, 24UL*p*((nlanes-1)*nblk + 1));
+  getlcgstate(s, x0, c0);
+  for(int l=1;l<nlanes;l++){
+    for(int i=0;i<9;i++) s[9*l+i] = s[9*(l-1)+i];
+    mul9x9mod(s + 9*l, B);
+  }
+  getranluxseq(y, k, s, nlanes);
+  for(int l=0;l<nlanes;l++){
+    for(int j=0;j<24;j++) x[j*nlanes + l] = y[24*l + j];
+    c[l] = k[l];
+  }
+}
+
+static const uint32_t checkpoint_magic = 0x49584c52; // "RLXI"
+
+// write the checkpoint header followed by the state vectors x of xsize
+// bytes and the carry bits c[nlanes], for buf = NULL only the size is
+// computed
+static size_t savecheckpoint(void *buf, int kind, int nlanes, int p, int pos,
+			     const void *x, size_t xsize, const uint32_t *c){
+  size_t size = sizeof(ranluxI_checkpoint) + xsize + nlanes*sizeof(uint32_t);
+  if(!buf) return size;
+  ranluxI_checkpoint h = {checkpoint_magic, (uint16_t)kind, (uint16_t)nlanes, p, pos};
+  uint8_t *b = (uint8_t*)buf;
+  memcpy(b, &h, sizeof(h)); b += sizeof(h);
+  memcpy(b, x, xsize); b += xsize;
+  memcpy(b, c, nlanes*sizeof(uint32_t));
+  return size;
+}
+
+// check the checkpoint header and size, returns the state vectors or NULL
+static const uint8_t *loadcheckpoint(const void *buf, size_t size, int kind, int nlanes,
+				     size_t xsize, ranluxI_checkpoint &h){
+  if(size < sizeof(h)) return NULL;
+  memcpy(&h, buf, sizeof(h));
+  if(h.magic != checkpoint_magic || h.kind != kind || h.nlanes != nlanes || h.p <= 0) return NULL;
+  if(size != sizeof(h) + xsize + nlanes*sizeof(uint32_t)) return NULL;
+  return (const uint8_t*)buf + sizeof(h);
+}
+
+bool getlcgstate(uint64_t x[9], const ranluxI_checkpoint *cp, size_t size, int lane){
+  ranluxI_checkpoint h;
+  if(size < sizeof(h)) return false;
+  memcpy(&h, cp, sizeof(h));
+  // the size of the state vectors of the kind, then the full validation
+  size_t xsize;
+  int nlanes = h.nlanes;
+  if(h.kind == ranluxI_checkpoint::SCALAR48){
+    xsize = 12*sizeof(uint64_t);
+    nlanes = 1;
+  } else if(h.kind == ranluxI_checkpoint::SCALAR){
+    xsize = 24*sizeof(uint32_t);
+    nlanes = 1;
+  } else if(h.kind == ranluxI_checkpoint::MULTI || h.kind == ranluxI_checkpoint::SIMD){
+    xsize = 24*sizeof(uint32_t)*nlanes;
+  } else
+    return false;
+  const uint8_t *b = loadcheckpoint(cp, size, h.kind, nlanes, xsize, h);
+  if(!b || lane < 0 || lane >= h.nlanes) return false;
+  uint32_t y[24], c;
+  int L = h.nlanes;
+  if(h.kind == ranluxI_checkpoint::SCALAR48){
+    uint64_t z[12];
+    memcpy(z, b, sizeof(z)); b += sizeof(z);
+    for(int i=0;i<12;i++){
+      y[2*i]   = z[i]>>24;
+      y[2*i+1] = z[i] & 0xffffff;
+    }
+  } else if(h.kind == ranluxI_checkpoint::SCALAR || h.kind == ranluxI_checkpoint::MULTI){
+    memcpy(y, b + 24*sizeof(uint32_t)*lane, sizeof(y));
+    b += 24*sizeof(uint32_t)*L;
+  } else if(h.kind == ranluxI_checkpoint::SIMD){
+    for(int k=0;k<24;k++) memcpy(y + k, b + sizeof(uint32_t)*(k*L + lane), sizeof(uint32_t));
+    b += 24*sizeof(uint32_t)*L;
+  } else
+    return false;
+  memcpy(&c, b + sizeof(uint32_t)*lane, sizeof(c));
+  getlcgstate(x, y, c);
+  return true;
+}
+
 ranluxI_scalar::ranluxI_scalar(int seed, int p):_p(p), _pos(24) {
   _c = 0x0;
   init(seed);
 #ifdef ASMSKIP
-  printf("Scalar ranlux skipping (asm version): wasting %d states (p=%d)\n", _p-1, _p*24);
+  ranlux_log("Scalar ranlux skipping (asm version): wasting %d states (p=%d)\n", _p-1, _p*24);
 #else
-  printf("Scalar ranlux skipping: wasting %d states (p=%d)\n", _p-1, _p*24);
+  ranlux_log("Scalar ranlux skipping: wasting %d states (p=%d)\n", _p-1, _p*24);
 #endif
 }
 
 void ranluxI_scalar::init(int iseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
   ANGen<24,13,31> s(iseed);
   for (int k=0; k<24; k++) _x[k] = s();
+  RANLUX_PROBE_END3(swb_init, this, 1, iseed);
 }
 
 void ranluxI_scalar::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, nstates);
 #ifdef ASMSKIP
   _c = _skipstates(_x, _c, nstates);
 #else
@@ -103,30 +281,312 @@ void ranluxI_scalar::nextstate(int nstates){
     return d>>31;
   };
   int32_t c = _c;
-  while(nstates-- > 0){
+  for(int n=nstates;n>0;n--){
     for(int i=23;i>13;i--) c = step(i,i-14,c);
     for(int i=13;i>=0;i--) c = step(i,i+10,c);
   }
   _c = c;
 #endif
+  RANLUX_PROBE_END3(swb_nextstate, this, 1, nstates);
+}
+
+void ranluxI_scalar::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  if(lcgjump_is_faster(nstates, 1, 1)){
+    lcgjump(_x, &_c, 1, nstates);
+    RANLUX_COUNT(states, nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, 1, nstates);
+}
+
+size_t ranluxI_scalar::save(void *buf) const {
+  return savecheckpoint(buf, ranluxI_checkpoint::SCALAR, 1, _p, _pos, _x, sizeof(_x), &_c);
+}
+
+bool ranluxI_scalar::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::SCALAR, 1, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > 24) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(&_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  return true;
+}
+
+ranluxI48_scalar::ranluxI48_scalar(int seed, int p):_p(p), _pos(12) {
+  _c = 0x0;
+  init(seed);
+#ifdef ASMSKIP
+  ranlux_log("Scalar 48-bit ranlux skipping (asm version): wasting %d states (p=%d)\n", _p-1, _p*24);
+#else
+  ranlux_log("Scalar 48-bit ranlux skipping: wasting %d states (p=%d)\n", _p-1, _p*24);
+#endif
+}
+
+void ranluxI48_scalar::init(int iseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  // the seeding of ranluxI_scalar
+  ANGen<24,13,31> s(iseed);
+  uint32_t x[24];
+  for (int k=0; k<24; k++) x[k] = s();
+  setstate(x, _c);
+  RANLUX_PROBE_END3(swb_init, this, 1, iseed);
+}
+
+void ranluxI48_scalar::getstate(uint32_t *x, uint32_t &c){
+  for(int i=0;i<12;i++){
+    x[2*i]   = _x[i]>>24;
+    x[2*i+1] = _x[i] & 0xffffff;
+  }
+  c = _c;
+}
+
+void ranluxI48_scalar::setstate(const uint32_t *x, uint32_t c){
+  for(int i=0;i<12;i++) _x[i] = (uint64_t)x[2*i]<<24 | x[2*i+1];
+  _c = c;
+}
+
+void ranluxI48_scalar::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, nstates);
+  if(nstates <= 0) return;
+#ifdef ASMSKIP
+  _c = _skipstates48(_x, _c, nstates);
+#else
+  auto step = [this](int i, int j, int c) -> int {
+    uint64_t d = _x[j] - _x[i] - c;
+    _x[i] = d & 0xffffffffffff;
+    return d>>63;
+  };
+  int c = _c;
+  for(int n=nstates;n>0;n--){
+    for(int i=11;i>6;i--) c = step(i,i-7,c);
+    for(int i=6;i>=0;i--) c = step(i,i+5,c);
+  }
+  _c = c;
+#endif
+  RANLUX_PROBE_END3(swb_nextstate, this, 1, nstates);
+}
+
+void ranluxI48_scalar::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  // a state advance costs about half of the scalar one
+  if(lcgjump_is_faster(nstates/2, 1, 1)){
+    uint32_t x[24], c;
+    getstate(x, c);
+    lcgjump(x, &c, 1, nstates);
+    setstate(x, c);
+    RANLUX_COUNT(states, nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, 1, nstates);
+}
+
+size_t ranluxI48_scalar::save(void *buf) const {
+  return savecheckpoint(buf, ranluxI_checkpoint::SCALAR48, 1, _p, _pos, _x, sizeof(_x), &_c);
+}
+
+bool ranluxI48_scalar::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::SCALAR48, 1, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > 12) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(&_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  return true;
+}
+
+template<int N>
+ranluxI_multi<N>::ranluxI_multi(int seed, int p):_p(p),_pos(N*24) {
+  for(int l=0;l<N;l++) _c[l] = 0;
+  init(seed);
+#ifdef ASMSKIP
+  ranlux_log("Interleaved scalar ranlux skipping (asm version, %d generators): wasting %d states (p=%d)\n", N, _p-1, _p*24);
+#else
+  ranlux_log("Interleaved scalar ranlux skipping (%d generators): wasting %d states (p=%d)\n", N, _p-1, _p*24);
+#endif
+}
+
+template<int N>
+void ranluxI_multi<N>::init(int iseed, bool sameseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  ANGen<24,13,31> s(iseed);
+  for (int k=0; k<24; k++){
+    if(!sameseed){
+      for (int l=0; l<N; l++) _x[l][k] = s();
+    } else {
+      uint32_t t = s();
+      for (int l=0; l<N; l++) _x[l][k] = t;
+    }
+  }
+  RANLUX_PROBE_END3(swb_init, this, N, iseed);
+}
+
+template<int N>
+void ranluxI_multi<N>::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, (uint64_t)N*nstates);
+#ifdef ASMSKIP
+  if(nstates <= 0) return;
+  if(N == 2) _skipstates2(_x[0], _c, nstates);
+  if(N == 4) _skipstates4(_x[0], _c, nstates);
+#else
+  for(int n=nstates;n>0;n--){
+    for(int l=0;l<N;l++){
+      uint32_t *x = _x[l];
+      auto step = [x](int i, int j, int c) -> int32_t {
+	uint32_t d = x[j] - x[i] - c;
+	x[i] = d & 0xffffff;
+	return d>>31;
+      };
+      int32_t c = _c[l];
+      for(int i=23;i>13;i--) c = step(i,i-14,c);
+      for(int i=13;i>=0;i--) c = step(i,i+10,c);
+      _c[l] = c;
+    }
+  }
+#endif
+  RANLUX_PROBE_END3(swb_nextstate, this, N, nstates);
+}
+
+template<int N>
+void ranluxI_multi<N>::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  if(lcgjump_is_faster(nstates, N, 1)){
+    // the LCG jump works on the interleaved state vectors
+    uint32_t x[24*N];
+    for(int l=0;l<N;l++) for(int k=0;k<24;k++) x[k*N + l] = _x[l][k];
+    lcgjump(x, _c, N, nstates);
+    for(int l=0;l<N;l++) for(int k=0;k<24;k++) _x[l][k] = x[k*N + l];
+    RANLUX_COUNT(states, (uint64_t)N*nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, N, nstates);
+}
+
+template<int N>
+size_t ranluxI_multi<N>::save(void *buf) const {
+  return savecheckpoint(buf, ranluxI_checkpoint::MULTI, N, _p, _pos, _x, sizeof(_x), _c);
+}
+
+template<int N>
+bool ranluxI_multi<N>::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::MULTI, N, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > N*24) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  return true;
 }
 
-ranluxI_SSE::ranluxI_SSE(int seed, int p):_p(p),_pos(4*24) {
+template class ranluxI_multi<2>;
+template class ranluxI_multi<4>;
+
+ranluxI_SSE::ranluxI_SSE(int seed, int p):_p(p),_pos(4*24),_seq(0) {
   _c = _mm_set1_epi32(0x0);
   init(seed);
-  printf("SSE2 ranlux skipping (4 generators in parallel): wasting %d states (p=%d)\n", _p-1, _p*24);
+  ranlux_log("SSE2 ranlux skipping (4 generators in parallel): wasting %d states (p=%d)\n", _p-1, _p*24);
 }
 
 void ranluxI_SSE::init(int iseed, bool sameseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  _seq = 0;
+  _sb.reset();
   ANGen<24,13,31> s(iseed);
   if(!sameseed){
     for (int k=0; k<24; k++) _x[k] = _mm_set_epi32(s(),s(),s(),s());
   }else{
     for (int k=0; k<24; k++) _x[k] = _mm_set1_epi32(s());
   }
+  RANLUX_PROBE_END3(swb_init, this, 4, iseed);
+}
+
+void ranluxI_SSE::initsequence(int iseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  ANGen<24,13,31> s(iseed);
+  uint32_t x0[24];
+  for (int k=0; k<24; k++) x0[k] = s();
+  // the seeded state is the exhausted block before the first one
+  setsequence(x0, 0, 24);
+  RANLUX_PROBE_END3(swb_init, this, 4, iseed);
+}
+
+void ranluxI_SSE::setsequence(const uint32_t *x0, uint32_t c0, int pos) {
+  if(!_sb) _sb.reset(new seqbuffer);
+  lcgsequence((uint32_t*)_x, (uint32_t*)&_c, 4, _nblk, _p, x0, c0, _sb->A);
+  nextsequence();
+  _pos = 4*pos;
+  _seq = 1;
+}
+
+void ranluxI_SSE::nextsequence() {
+  for(int m=0;m<_nblk;m++){
+    if(m) nextstate(_p);
+    for(int k=0;k<24;k++) _sb->y[24*m + k] = _x[k];
+    _sb->cy[m] = _c;
+  }
+  lcgmul((uint32_t*)_x, (uint32_t*)&_c, 4, _sb->A);
+  countrefill((uint64_t)4*(_nblk - 1)*(_p - 1)*RANLUX_STATE_BITS);
+}
+
+void ranluxI_SSE::getblock(uint32_t *x, uint32_t &c, int &pos) const {
+  // the last delivered number, nothing is delivered from the first block
+  // only after the sequence is set with pos = 0
+  int i = _pos ? _pos - 4 : 0, l = i%4, m = i/4/24, k = i/4%24;
+  c = ((const uint32_t*)&_sb->cy[m])[l];
+  for(int j=0;j<24;j++) x[j] = ((const uint32_t*)&_sb->y[24*m + j])[l];
+  pos = _pos ? k + 1 : 0;
+}
+
+size_t ranluxI_SSE::save(void *buf) const {
+  if(_seq){
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    return savecheckpoint(buf, ranluxI_checkpoint::SCALAR, 1, _p, pos, x, sizeof(x), &c);
+  }
+  return savecheckpoint(buf, ranluxI_checkpoint::SIMD, 4, _p, _pos, _x, sizeof(_x), (const uint32_t*)&_c);
+}
+
+bool ranluxI_SSE::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  uint32_t x[24], c;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::SCALAR, 1, sizeof(x), h);
+  if(b){
+    // a block of the sequence
+    if(h.pos < 0 || h.pos > 24) return false;
+    memcpy(x, b, sizeof(x));
+    memcpy(&c, b + sizeof(x), sizeof(c));
+    _p = h.p;
+    setsequence(x, c, h.pos);
+    return true;
+  }
+  b = loadcheckpoint(buf, size, ranluxI_checkpoint::SIMD, 4, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > 4*24) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(&_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  _seq = 0;
+  _sb.reset();
+  return true;
 }
 
 void ranluxI_SSE::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, (uint64_t)4*nstates);
   auto step = [this](int i, int j, __m128i c) {
     const __m128i m = _mm_set1_epi32(0xffffff);
     __m128i d = _mm_sub_epi32(_mm_sub_epi32(_x[j], _x[i]), c);
@@ -135,30 +595,133 @@ void ranluxI_SSE::nextstate(int nstates){
   };
 
   __m128i c = _c;
-  while(nstates-- > 0){
+  for(int n=nstates;n>0;n--){
     for(int i=23;i>13;i--) c = step(i,i-14,c);
     for(int i=13;i>=0;i--) c = step(i,i+10,c);
   }
   _c = c;
+  RANLUX_PROBE_END3(swb_nextstate, this, 4, nstates);
+}
+
+void ranluxI_SSE::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  if(_seq){
+    // restart the sequence from the current block skipped by nstates
+    if(!nstates) return;
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    lcgjump(x, &c, 1, nstates);
+    setsequence(x, c, pos);
+    RANLUX_COUNT(states, nstates);
+    RANLUX_PROBE_END3(swb_jump, this, 4, nstates);
+    return;
+  }
+  if(lcgjump_is_faster(nstates, 4, 2)){
+    lcgjump((uint32_t*)_x, (uint32_t*)&_c, 4, nstates);
+    RANLUX_COUNT(states, (uint64_t)4*nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, 4, nstates);
 }
 
 #ifdef __AVX2__
-ranluxI_AVX::ranluxI_AVX(int seed, int p):_p(p),_pos(8*24) {
+ranluxI_AVX::ranluxI_AVX(int seed, int p):_p(p),_pos(8*24),_seq(0) {
   _c = _mm256_set1_epi32(0x0);
   init(seed);
-  printf("AVX2 ranlux skipping (8 generators in parallel): wasting %d states (p=%d)\n", _p-1, _p*24);
+  ranlux_log("AVX2 ranlux skipping (8 generators in parallel): wasting %d states (p=%d)\n", _p-1, _p*24);
 }
 
 void ranluxI_AVX::init(int iseed, bool sameseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  _seq = 0;
+  _sb.reset();
   ANGen<24,13,31> s(iseed);
   if(!sameseed){
     for (int k=0; k<24; k++) _x[k] = _mm256_set_epi32(s(),s(),s(),s(),s(),s(),s(),s());
   } else {
     for (int k=0; k<24; k++) _x[k] = _mm256_set1_epi32(s());
   }
+  RANLUX_PROBE_END3(swb_init, this, 8, iseed);
+}
+
+void ranluxI_AVX::initsequence(int iseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  ANGen<24,13,31> s(iseed);
+  uint32_t x0[24];
+  for (int k=0; k<24; k++) x0[k] = s();
+  // the seeded state is the exhausted block before the first one
+  setsequence(x0, 0, 24);
+  RANLUX_PROBE_END3(swb_init, this, 8, iseed);
+}
+
+void ranluxI_AVX::setsequence(const uint32_t *x0, uint32_t c0, int pos) {
+  if(!_sb) _sb.reset(new seqbuffer);
+  lcgsequence((uint32_t*)_x, (uint32_t*)&_c, 8, _nblk, _p, x0, c0, _sb->A);
+  nextsequence();
+  _pos = 8*pos;
+  _seq = 1;
+}
+
+void ranluxI_AVX::nextsequence() {
+  for(int m=0;m<_nblk;m++){
+    if(m) nextstate(_p);
+    for(int k=0;k<24;k++) _sb->y[24*m + k] = _x[k];
+    _sb->cy[m] = _c;
+  }
+  lcgmul((uint32_t*)_x, (uint32_t*)&_c, 8, _sb->A);
+  countrefill((uint64_t)8*(_nblk - 1)*(_p - 1)*RANLUX_STATE_BITS);
+}
+
+void ranluxI_AVX::getblock(uint32_t *x, uint32_t &c, int &pos) const {
+  // the last delivered number, nothing is delivered from the first block
+  // only after the sequence is set with pos = 0
+  int i = _pos ? _pos - 8 : 0, l = i%8, m = i/8/24, k = i/8%24;
+  c = ((const uint32_t*)&_sb->cy[m])[l];
+  for(int j=0;j<24;j++) x[j] = ((const uint32_t*)&_sb->y[24*m + j])[l];
+  pos = _pos ? k + 1 : 0;
+}
+
+size_t ranluxI_AVX::save(void *buf) const {
+  if(_seq){
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    return savecheckpoint(buf, ranluxI_checkpoint::SCALAR, 1, _p, pos, x, sizeof(x), &c);
+  }
+  return savecheckpoint(buf, ranluxI_checkpoint::SIMD, 8, _p, _pos, _x, sizeof(_x), (const uint32_t*)&_c);
+}
+
+bool ranluxI_AVX::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  uint32_t x[24], c;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::SCALAR, 1, sizeof(x), h);
+  if(b){
+    // a block of the sequence
+    if(h.pos < 0 || h.pos > 24) return false;
+    memcpy(x, b, sizeof(x));
+    memcpy(&c, b + sizeof(x), sizeof(c));
+    _p = h.p;
+    setsequence(x, c, h.pos);
+    return true;
+  }
+  b = loadcheckpoint(buf, size, ranluxI_checkpoint::SIMD, 8, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > 8*24) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(&_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  _seq = 0;
+  _sb.reset();
+  return true;
 }
 
 void ranluxI_AVX::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, (uint64_t)8*nstates);
   auto step = [this](int i, int j, __m256i c) {
     const __m256i m = _mm256_set1_epi32(0xffffff);
     __m256i d = _mm256_sub_epi32(_mm256_sub_epi32(_x[j], _x[i]), c);
@@ -167,11 +730,174 @@ void ranluxI_AVX::nextstate(int nstates){
   };
   
   __m256i c = _c;
-  while(nstates-- > 0){
+  for(int n=nstates;n>0;n--){
     for(int i=23;i>13;i--) c = step(i,i-14,c);
     for(int i=13;i>=0;i--) c = step(i,i+10,c);
   }
   _c = c;
+  RANLUX_PROBE_END3(swb_nextstate, this, 8, nstates);
+}
+
+void ranluxI_AVX::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  if(_seq){
+    // restart the sequence from the current block skipped by nstates
+    if(!nstates) return;
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    lcgjump(x, &c, 1, nstates);
+    setsequence(x, c, pos);
+    RANLUX_COUNT(states, nstates);
+    RANLUX_PROBE_END3(swb_jump, this, 8, nstates);
+    return;
+  }
+  if(lcgjump_is_faster(nstates, 8, 2)){
+    lcgjump((uint32_t*)_x, (uint32_t*)&_c, 8, nstates);
+    RANLUX_COUNT(states, (uint64_t)8*nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, 8, nstates);
+}
+#endif
+
+#ifdef __AVX512F__
+ranluxI_AVX512::ranluxI_AVX512(int seed, int p):_p(p),_pos(16*24),_seq(0) {
+  _c = _mm512_set1_epi32(0x0);
+  init(seed);
+  ranlux_log("AVX-512 ranlux skipping (16 generators in parallel): wasting %d states (p=%d)\n", _p-1, _p*24);
+}
+
+void ranluxI_AVX512::init(int iseed, bool sameseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  _seq = 0;
+  _sb.reset();
+  ANGen<24,13,31> s(iseed);
+  if(!sameseed){
+    for (int k=0; k<24; k++) _x[k] = _mm512_set_epi32(s(),s(),s(),s(),s(),s(),s(),s(),
+						     s(),s(),s(),s(),s(),s(),s(),s());
+  } else {
+    for (int k=0; k<24; k++) _x[k] = _mm512_set1_epi32(s());
+  }
+  RANLUX_PROBE_END3(swb_init, this, 16, iseed);
+}
+
+void ranluxI_AVX512::initsequence(int iseed) {
+  RANLUX_PROBE_BEGIN(swb_init);
+  RANLUX_COUNT(jumps, 1);
+  ANGen<24,13,31> s(iseed);
+  uint32_t x0[24];
+  for (int k=0; k<24; k++) x0[k] = s();
+  // the seeded state is the exhausted block before the first one
+  setsequence(x0, 0, 24);
+  RANLUX_PROBE_END3(swb_init, this, 16, iseed);
+}
+
+void ranluxI_AVX512::setsequence(const uint32_t *x0, uint32_t c0, int pos) {
+  if(!_sb) _sb.reset(new seqbuffer);
+  lcgsequence((uint32_t*)_x, (uint32_t*)&_c, 16, _nblk, _p, x0, c0, _sb->A);
+  nextsequence();
+  _pos = 16*pos;
+  _seq = 1;
+}
+
+void ranluxI_AVX512::nextsequence() {
+  for(int m=0;m<_nblk;m++){
+    if(m) nextstate(_p);
+    for(int k=0;k<24;k++) _sb->y[24*m + k] = _x[k];
+    _sb->cy[m] = _c;
+  }
+  lcgmul((uint32_t*)_x, (uint32_t*)&_c, 16, _sb->A);
+  countrefill((uint64_t)16*(_nblk - 1)*(_p - 1)*RANLUX_STATE_BITS);
+}
+
+void ranluxI_AVX512::getblock(uint32_t *x, uint32_t &c, int &pos) const {
+  // the last delivered number, nothing is delivered from the first block
+  // only after the sequence is set with pos = 0
+  int i = _pos ? _pos - 16 : 0, l = i%16, m = i/16/24, k = i/16%24;
+  c = ((const uint32_t*)&_sb->cy[m])[l];
+  for(int j=0;j<24;j++) x[j] = ((const uint32_t*)&_sb->y[24*m + j])[l];
+  pos = _pos ? k + 1 : 0;
+}
+
+size_t ranluxI_AVX512::save(void *buf) const {
+  if(_seq){
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    return savecheckpoint(buf, ranluxI_checkpoint::SCALAR, 1, _p, pos, x, sizeof(x), &c);
+  }
+  return savecheckpoint(buf, ranluxI_checkpoint::SIMD, 16, _p, _pos, _x, sizeof(_x), (const uint32_t*)&_c);
+}
+
+bool ranluxI_AVX512::load(const void *buf, size_t size){
+  ranluxI_checkpoint h;
+  uint32_t x[24], c;
+  const uint8_t *b = loadcheckpoint(buf, size, ranluxI_checkpoint::SCALAR, 1, sizeof(x), h);
+  if(b){
+    // a block of the sequence
+    if(h.pos < 0 || h.pos > 24) return false;
+    memcpy(x, b, sizeof(x));
+    memcpy(&c, b + sizeof(x), sizeof(c));
+    _p = h.p;
+    setsequence(x, c, h.pos);
+    return true;
+  }
+  b = loadcheckpoint(buf, size, ranluxI_checkpoint::SIMD, 16, sizeof(_x), h);
+  if(!b || h.pos < 0 || h.pos > 16*24) return false;
+  memcpy(_x, b, sizeof(_x));
+  memcpy(&_c, b + sizeof(_x), sizeof(_c));
+  _p = h.p;
+  _pos = h.pos;
+  _seq = 0;
+  _sb.reset();
+  return true;
+}
+
+void ranluxI_AVX512::nextstate(int nstates){
+  RANLUX_PROBE_BEGIN(swb_nextstate);
+  RANLUX_COUNT(states, (uint64_t)16*nstates);
+  auto step = [this](int i, int j, __m512i c) {
+    const __m512i m = _mm512_set1_epi32(0xffffff);
+    __m512i d = _mm512_sub_epi32(_mm512_sub_epi32(_x[j], _x[i]), c);
+    _x[i] = _mm512_and_si512(d, m);
+    // the zero-masked form keeps gcc from warning about the undefined
+    // pass-through operand of _mm512_srli_epi32
+    return _mm512_maskz_srli_epi32(0xffff, d, 31);
+  };
+
+  __m512i c = _c;
+  for(int n=nstates;n>0;n--){
+    for(int i=23;i>13;i--) c = step(i,i-14,c);
+    for(int i=13;i>=0;i--) c = step(i,i+10,c);
+  }
+  _c = c;
+  RANLUX_PROBE_END3(swb_nextstate, this, 16, nstates);
+}
+
+void ranluxI_AVX512::jump(uint64_t nstates){
+  RANLUX_PROBE_BEGIN(swb_jump);
+  RANLUX_COUNT(jumps, 1);
+  if(_seq){
+    // restart the sequence from the current block skipped by nstates
+    if(!nstates) return;
+    uint32_t x[24], c;
+    int pos;
+    getblock(x, c, pos);
+    lcgjump(x, &c, 1, nstates);
+    setsequence(x, c, pos);
+    RANLUX_COUNT(states, nstates);
+    RANLUX_PROBE_END3(swb_jump, this, 16, nstates);
+    return;
+  }
+  if(lcgjump_is_faster(nstates, 16, 2)){
+    lcgjump((uint32_t*)_x, (uint32_t*)&_c, 16, nstates);
+    RANLUX_COUNT(states, (uint64_t)16*nstates);
+  } else
+    nextstate(nstates);
+  RANLUX_PROBE_END3(swb_jump, this, 16, nstates);
 }
 #endif
 
@@ -229,23 +955,23 @@ void ranluxI_James::setlux(int lux){
   }
   if(_luxury<=4){
     _nskip = lux_levels[_luxury];
-    printf(" RANLUX LUXURY LEVEL SET BY RLUXGO :%2d     P=%4d\n",_luxury,_nskip+24);
+    ranlux_log(" RANLUX LUXURY LEVEL SET BY RLUXGO :%2d     P=%4d\n",_luxury,_nskip+24);
   } else {
     _nskip = _luxury - 24;
-    printf(" RANLUX P-VALUE SET BY RLUXGO :%5d\n",_luxury);
+    ranlux_log(" RANLUX P-VALUE SET BY RLUXGO :%5d\n",_luxury);
   }
 }
 
 void ranluxI_James::rluxgo(int lux, int seed, int k1, int k2) {
   setlux(lux);
   if(seed<0)
-    printf(" Illegal initialization by RLUXGO, negative input seed\n");
+    ranlux_log(" Illegal initialization by RLUXGO, negative input seed\n");
   if(seed>0){
     _seed = seed;
-    printf(" RANLUX INITIALIZED BY RLUXGO FROM SEEDS%12d%12d%12d\n",_seed,k1,k2);
+    ranlux_log(" RANLUX INITIALIZED BY RLUXGO FROM SEEDS%12d%12d%12d\n",_seed,k1,k2);
   } else {
     _seed = 314159265;
-    printf(" RANLUX INITIALIZED BY RLUXGO FROM DEFAULT SEED\n");
+    ranlux_log(" RANLUX INITIALIZED BY RLUXGO FROM DEFAULT SEED\n");
   }
   
   LEcuyer ns(_seed);
@@ -255,17 +981,16 @@ void ranluxI_James::rluxgo(int lux, int seed, int k1, int k2) {
   _i    = 0;
   _in24 = 0;
 
-  _kount = k1 + k2*(1000*1000*1000);
+  _kount = k1 + k2*(uint64_t)(1000*1000*1000);
   uint64_t nstates = (_kount + 24 - _i)/24;
   _i   += nstates*24 - _kount;
-  if(nstates) nextstate(nstates);
+  if(nstates) jump(nstates);
 }
 
 void ranluxI_James::rluxin(int state[25]){
-  printf("FULL INITIALIZATION OF RANLUX WITH 25 INTEGERS:\n");
-  for(int i=0;i<25;i++) {
-    printf("%12d", state[i]); if(!((i+1)%5)) printf("\n");
-  }
+  ranlux_log("FULL INITIALIZATION OF RANLUX WITH 25 INTEGERS:\n");
+  for(int i=0;i<25;i+=5)
+    ranlux_log("%12d%12d%12d%12d%12d\n", state[i], state[i+1], state[i+2], state[i+3], state[i+4]);
   for(int i=0;i<24;i++) _x[i] = state[i];
   int isd = state[24];
   _c = isd<0;
@@ -319,9 +1044,44 @@ int ranluxpp_James::nextpos(){
   return --_i;
 }
 
+// convert the whole unpacked sequence to floats in the delivery order
+// y[23], y[22] ... y[0] with the small-value fix-up of tofloat done
+// without branches
+void ranluxpp_James::tofloats(float *v){
+#ifdef __AVX2__
+  // the sequence has just been written by scalar stores, gather it
+  // element-wise to avoid store forwarding stalls of vector loads
+  auto y = [this](int k){ return (int)_y[(k+24)%24]; };
+  const __m256i lim = _mm256_set1_epi32(1<<12);
+  const __m256 s24 = _mm256_set1_ps(1.0f/0x1p24f), s36 = _mm256_set1_ps(1.0f/0x1p36f),
+    s48 = _mm256_set1_ps(1.0f/0x1p48f);
+  for(int b=0;b<3;b++){
+    int i = 23 - 8*b; // i-th number goes to v[8*b], j = i + 10 mod 24 is its lag
+    __m256i x  = _mm256_set_epi32(y(i-7), y(i-6), y(i-5), y(i-4), y(i-3), y(i-2), y(i-1), y(i));
+    __m256i xj = _mm256_set_epi32(y(i+3), y(i+4), y(i+5), y(i+6), y(i+7), y(i+8), y(i+9), y(i+10));
+    __m256i small = _mm256_cmpgt_epi32(lim, x);
+    __m256i xs = _mm256_add_epi32(_mm256_slli_epi32(x, 12), _mm256_srli_epi32(xj, 12));
+    x = _mm256_blendv_epi8(x, xs, small);
+    __m256 sc = _mm256_blendv_ps(s24, s36, _mm256_castsi256_ps(small));
+    __m256 f = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(x), sc), s48);
+    _mm256_storeu_ps(v + 8*b, f);
+  }
+#else
+  for(int k=0;k<24;k++) v[k] = tofloat(23-k);
+#endif
+}
+
 void ranluxpp_James::ranlux(float *v, int n) {
-  for(int i=0;i<n;i++) v[i] = tofloat(nextpos());
   _kount += n;
+  // prologue, deliver the rest of the current sequence
+  for(;n>0 && _i>0;n--) *v++ = tofloat(--_i);
+  // whole sequences: advance the state, unpack and convert by blocks
+  for(;n>=24;n-=24,v+=24){
+    skip();
+    tofloats(v);
+  }
+  // epilogue
+  for(;n>0;n--) *v++ = tofloat(nextpos());
 }
 
 void ranluxpp_James::setlux(int lux){
@@ -340,10 +1100,10 @@ void ranluxpp_James::setlux(int lux){
   }
   if(_luxury<=4){
     _nskip = lux_levels[_luxury];
-    printf(" RANLUX LUXURY LEVEL SET BY RLUXGO :%2d     P=%4d\n",_luxury,_nskip+24);
+    ranlux_log(" RANLUX LUXURY LEVEL SET BY RLUXGO :%2d     P=%4d\n",_luxury,_nskip+24);
   } else {
     _nskip = _luxury - 24;
-    printf(" RANLUX P-VALUE SET BY RLUXGO :%5d\n",_luxury);
+    ranlux_log(" RANLUX P-VALUE SET BY RLUXGO :%5d\n",_luxury);
   }
   setskip(_nskip+24);
 }
@@ -351,13 +1111,13 @@ void ranluxpp_James::setlux(int lux){
 void ranluxpp_James::rluxgo(int lux, int seed, int k1, int k2) {
   setlux(lux);
   if(seed<0)
-    printf(" Illegal initialization by RLUXGO, negative input seed\n");
+    ranlux_log(" Illegal initialization by RLUXGO, negative input seed\n");
   if(seed>0){
     _seed = seed;
-    printf(" RANLUX INITIALIZED BY RLUXGO FROM SEEDS%12d%12d%12d\n",_seed,k1,k2);
+    ranlux_log(" RANLUX INITIALIZED BY RLUXGO FROM SEEDS%12d%12d%12d\n",_seed,k1,k2);
   } else {
     _seed = 314159265;
-    printf(" RANLUX INITIALIZED BY RLUXGO FROM DEFAULT SEED\n");
+    ranlux_log(" RANLUX INITIALIZED BY RLUXGO FROM DEFAULT SEED\n");
   }
 
   LEcuyer ns(_seed);
@@ -370,17 +1130,16 @@ void ranluxpp_James::rluxgo(int lux, int seed, int k1, int k2) {
 
   _i = 0;
 
-  _kount = k1 + k2*(1000*1000*1000);
+  _kount = k1 + k2*(uint64_t)(1000*1000*1000);
   uint64_t nstates = (_kount + 24 - _i)/24;
   _i += nstates*24 - _kount;
   if(_kount) jump(_kount);
 }
 
 void ranluxpp_James::rluxin(int state[25]){
-  printf("FULL INITIALIZATION OF RANLUX WITH 25 INTEGERS:\n");
-  for(int i=0;i<25;i++) {
-    printf("%12d", state[i]); if(!((i+1)%5)) printf("\n");
-  }
+  ranlux_log("FULL INITIALIZATION OF RANLUX WITH 25 INTEGERS:\n");
+  for(int i=0;i<25;i+=5)
+    ranlux_log("%12d%12d%12d%12d%12d\n", state[i], state[i+1], state[i+2], state[i+3], state[i+4]);
   for(int i=0;i<24;i++) _y[i] = state[i];
   int isd = state[24];
   _c = isd<0;
@@ -0,0 +1,199 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#include "ranluxauto.h"
+#include "cpuarch.h"
+#include <string.h>
+#include <chrono>
+#include <mutex>
+using namespace std::chrono;
+
+// Calibration table: the cost in ns per 24-bit number is slope*p + offset
+// for the engines SCALAR, SCALAR48, SSE, AVX and LCG, the SIMD engines
+// work in the sequence mode. The architectures are named as by getarch(),
+// a row is the output of "./ranlux_test 18" on such a CPU. Without a row
+// for the running CPU the model is measured once on its first use.
+// Haswell, Broadwell and Skylake need rows measured on those CPUs.
+struct costmodel {
+  const char *arch;
+  double slope[5], offset[5];
+};
+
+static const costmodel costtable[] = {
+  // a Xeon none of the targets of getarch() matches, AVX2 build
+  {"default", {0.59, 0.36, 0.34, 0.18, 0.003}, {4.0, 1.1, 4.4, 4.8, 12.3}},
+  {NULL, {0}, {0}} // end of the table
+};
+
+// the model in use, set on the first use or replaced by a calibration
+static costmodel costcurrent = {NULL, {0}, {0}};
+static std::once_flag costonce;
+static std::mutex costlock;
+
+static costmodel measurecost();
+
+static costmodel getcostmodel(){
+  std::call_once(costonce, [](){
+      const char *arch = getarch();
+      for(const costmodel *c = costtable; c->arch; c++)
+	if(!strcmp(c->arch, arch)){ costcurrent = *c; return; }
+      costcurrent = measurecost();
+    });
+  std::lock_guard<std::mutex> l(costlock);
+  return costcurrent;
+}
+
+template<typename T>
+double ranluxI_auto<T>::cost(int backend, int p){
+  costmodel c = getcostmodel();
+  return c.slope[backend]*p + c.offset[backend];
+}
+
+template<typename T>
+int ranluxI_auto<T>::select(int p){
+  int best = SCALAR;
+  for(int b=0;b<NBACKENDS;b++){
+    if(b == SCALAR48 && sizeof(T) != sizeof(double)) continue;
+#ifndef __AVX2__
+    if(b == AVX) continue;
+#endif
+    if(cost(b, p) < cost(best, p)) best = b;
+  }
+  return best;
+}
+
+template<typename T>
+const char *ranluxI_auto<T>::backendname(int backend){
+  const char *names[] = {"scalar", "scalar 48-bit", "SSE2", "AVX2", "LCG"};
+  return (backend >= 0 && backend < NBACKENDS) ? names[backend] : "unknown";
+}
+
+// keeps the timed loops of the calibration
+static volatile double calibsink;
+
+// time the engines at two luxuries for the linear fit
+static costmodel measurecost(){
+  typedef ranluxI_auto<float> A;
+  const int p0 = 4, p1 = 64, N = 1000*1000;
+  costmodel c = {getarch(), {0}, {0}};
+  for(int b=0;b<A::NBACKENDS;b++){
+#ifndef __AVX2__
+    if(b == A::AVX) continue;
+#endif
+    double t[2];
+    int p[2] = {p0, p1};
+    for(int i=0;i<2;i++){
+      // two sums to keep the addition latency off the measurement
+      double s0 = 0, s1 = 0;
+      auto start = high_resolution_clock::now();
+      if(b == A::SCALAR48){
+	ranluxI_auto<double> g(1, p[i], b);
+	start = high_resolution_clock::now();
+	for(int j=0;j<N/2;j+=2){ s0 += g(); s1 += g(); }
+      } else {
+	A g(1, p[i], b);
+	start = high_resolution_clock::now();
+	for(int j=0;j<N;j+=2){ s0 += g(); s1 += g(); }
+      }
+      t[i] = duration<double, std::nano>(high_resolution_clock::now() - start).count()/N;
+      calibsink = s0 + s1;
+    }
+    c.slope[b] = (t[1] - t[0])/(p1 - p0);
+    if(c.slope[b] < 0) c.slope[b] = 0;
+    c.offset[b] = t[0] - c.slope[b]*p0;
+  }
+  return c;
+}
+
+template<typename T>
+void ranluxI_auto<T>::calibrate(){
+  getcostmodel(); // the model of the first use is not measured again later
+  costmodel c = measurecost();
+  std::lock_guard<std::mutex> l(costlock);
+  costcurrent = c;
+}
+
+template<typename T>
+ranluxI_auto<T>::ranluxI_auto(int seed, int p, int backend) :
+  _scalar(NULL), _scalar48(NULL), _sse(NULL),
+#ifdef __AVX2__
+  _avx(NULL),
+#endif
+  _lcg(NULL), _pos(24) {
+  if(backend < 0 || backend >= NBACKENDS) backend = select(p);
+  if(backend == SCALAR48 && sizeof(T) != sizeof(double)) backend = SCALAR;
+#ifndef __AVX2__
+  if(backend == AVX) backend = SSE;
+#endif
+  _backend = backend;
+  if(backend == SCALAR){
+    _scalar = new ranluxI_scalar(seed, p);
+  } else if(backend == SCALAR48){
+    _scalar48 = new ranluxI48_scalar(seed, p);
+  } else if(backend == SSE){
+    _sse = new ranluxI_SSE(seed, p);
+    _sse->initsequence(seed);
+#ifdef __AVX2__
+  } else if(backend == AVX){
+    _avx = new ranluxI_AVX(seed, p);
+    _avx->initsequence(seed);
+#endif
+  } else {
+    // the seeded ranluxI_scalar state as the LCG state
+    ranluxI_scalar s(seed, p);
+    uint32_t x[24], c;
+    s.getstate(x, c);
+    _lcg = new ranluxpp(0, 24*p);
+    getlcgstate(_lcg->getstate(), x, c);
+  }
+}
+
+template<typename T>
+ranluxI_auto<T>::~ranluxI_auto(){
+  delete _scalar;
+  delete _scalar48;
+  delete _sse;
+#ifdef __AVX2__
+  delete _avx;
+#endif
+  delete _lcg;
+}
+
+template<typename T>
+void ranluxI_auto<T>::nextlcg(){
+  _lcg->nextstate();
+  getranluxseq(_y, _lcg->getstate());
+  _pos = 0;
+}
+
+template<typename T>
+ranluxstats ranluxI_auto<T>::getstats() const {
+  if(_scalar) return _scalar->getstats();
+  if(_scalar48) return _scalar48->getstats();
+  if(_sse) return _sse->getstats();
+#ifdef __AVX2__
+  if(_avx) return _avx->getstats();
+#endif
+  return _lcg->getstats();
+}
+
+template class ranluxI_auto<float>;
+template class ranluxI_auto<double>;
@@ -21,23 +21,14 @@
 
 #include "ranluxpp.h"
 #include "mulmod.h"
+#include "ranluxprobes.h"
 #include <stdio.h>
 #include <inttypes.h>
 
-// modular exponentiation:
-// x <- x^n mod (2^576 - 2^240 + 1)
-void powmod(uint64_t *x, unsigned long int n){
-  uint64_t res[9];
-  res[0] = 1;
-  for(int i=1;i<9;i++) res[i] = 0;
-  while(n){
-    if(n&1) mul9x9mod(res, x);
-    n >>= 1;
-    if(!n) break;
-    mul9x9mod(x, x);
-  }
-  for(int i=0;i<9;i++) x[i] = res[i];
-}
+RANLUX_PROBE_SEMAPHORE(pp_refill);
+RANLUX_PROBE_SEMAPHORE(pp_init);
+RANLUX_PROBE_SEMAPHORE(pp_jump);
+RANLUX_PROBE_SEMAPHORE(pp_setskip);
 
 const uint64_t *ranluxpp::geta(){
   static const uint64_t
@@ -57,15 +48,24 @@ ranluxpp::ranluxpp(uint64_t seed, uint64_t p) : _dpos(11), _fpos(24) {
 
 // the core of LCG -- modular mulitplication
 void ranluxpp::nextstate(){
+  RANLUX_COUNT(states, 1);
   mul9x9mod(_x,_A);
 }
   
 void ranluxpp::nextfloats() {
+  RANLUX_PROBE_BEGIN(pp_refill);
+  RANLUX_COUNT(refills, 1);
+  _nrefill++;
   nextstate(); unpackfloats((float*)_floats); _fpos = 0;
+  RANLUX_PROBE_END2(pp_refill, this, _nrefill);
 }
   
 void ranluxpp::nextdoubles() {
+  RANLUX_PROBE_BEGIN(pp_refill);
+  RANLUX_COUNT(refills, 1);
+  _nrefill++;
   nextstate(); unpackdoubles((double*)_doubles); _dpos = 0;
+  RANLUX_PROBE_END2(pp_refill, this, _nrefill);
 }
   
 // unpack state into single precision format
@@ -93,6 +93,7 @@ void ranluxpp::unpackdoubles(double *d) {
     one = 0x3ff0000000000000, // exponent
     m   = 0x000fffffffffffff; // mantissa
   uint64_t *id = (uint64_t*)d;
+  RANLUX_COUNT(discarded, RANLUX_STATE_BITS - 11*52);
   id[ 0] = one | (m & _x[0]);
   id[ 1] = one | (m & ((_x[0]>>52)|(_x[1]<<12)));
   id[ 2] = one | (m & ((_x[1]>>40)|(_x[2]<<24)));
@@ -165,25 +166,34 @@ void ranluxpp::primitive(){
 }
 
 void ranluxpp::init(uint64_t seed){
+  RANLUX_PROBE_BEGIN(pp_init);
   uint64_t a[9];
   for(int i=0;i<9;i++) a[i] = _A[i];
   powmod(a, 1UL<<48); powmod(a, 1UL<<48); // skip 2^96 states
   powmod(a, seed); // skip 2^96*seed states
   mul9x9mod(_x, a);
+  _nrefill = 0;
+  RANLUX_COUNT(jumps, 1);
+  RANLUX_PROBE_END2(pp_init, this, seed);
 }
 
 // jump ahead by n 24-bit RANLUX numbers
 void ranluxpp::jump(uint64_t n){
+  RANLUX_PROBE_BEGIN(pp_jump);
   uint64_t a[9];
   for(int i=0;i<9;i++) a[i] = geta()[i];
   powmod(a, n);
   mul9x9mod(_x, a);
+  RANLUX_COUNT(jumps, 1);
+  RANLUX_PROBE_END2(pp_jump, this, n);
 }
 
 // set skip factor to emulate RANLUX behaviour
 void ranluxpp::setskip(uint64_t n){
+  RANLUX_PROBE_BEGIN(pp_setskip);
   for(int i=0;i<9;i++) _A[i] = geta()[i];
   powmod(_A, n);
+  RANLUX_PROBE_END2(pp_setskip, this, n);
 }
 
 // print state
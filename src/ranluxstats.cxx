@@ -0,0 +1,99 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#include "ranluxstats.h"
+#include <inttypes.h>
+#ifdef RANLUX_STATS
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#endif
+
+void ranluxstats::print(FILE *stream) const {
+  fprintf(stream, "states %" PRIu64 ", refills %" PRIu64 ", jumps %" PRIu64 ", discarded bits %" PRIu64 "\n",
+	  states, refills, jumps, discarded);
+}
+
+#ifdef RANLUX_STATS
+thread_local ranluxstats_counters *ranluxstats_tls = NULL;
+
+namespace {
+  // the counters of the running threads and the sum of the finished ones
+  struct registry {
+    std::mutex lock;
+    std::vector<ranluxstats_counters*> threads;
+    ranluxstats finished;
+  };
+
+  registry &getregistry(){
+    static registry *r = new registry; // alive until the last thread is gone
+    return *r;
+  }
+
+  ranluxstats snapshot(const ranluxstats_counters &c){
+    ranluxstats s;
+    s.states = c.states.load(std::memory_order_relaxed);
+    s.refills = c.refills.load(std::memory_order_relaxed);
+    s.jumps = c.jumps.load(std::memory_order_relaxed);
+    s.discarded = c.discarded.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // the counters of a thread, moved to the finished sum at its exit
+  struct threadcounters {
+    ranluxstats_counters c;
+    threadcounters(){
+      registry &r = getregistry();
+      std::lock_guard<std::mutex> g(r.lock);
+      r.threads.push_back(&c);
+    }
+    ~threadcounters(){
+      registry &r = getregistry();
+      std::lock_guard<std::mutex> g(r.lock);
+      r.finished += snapshot(c);
+      r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &c));
+      ranluxstats_tls = NULL;
+    }
+  };
+}
+
+ranluxstats_counters *ranluxstats_register(){
+  static thread_local threadcounters t;
+  ranluxstats_tls = &t.c;
+  return ranluxstats_tls;
+}
+
+ranluxstats ranluxstats_thread(){
+  return ranluxstats_tls ? snapshot(*ranluxstats_tls) : ranluxstats();
+}
+
+ranluxstats ranluxstats_total(){
+  registry &r = getregistry();
+  std::lock_guard<std::mutex> g(r.lock);
+  ranluxstats s = r.finished;
+  for(ranluxstats_counters *c : r.threads) s += snapshot(*c);
+  return s;
+}
+#else
+ranluxstats ranluxstats_thread(){ return ranluxstats(); }
+
+ranluxstats ranluxstats_total(){ return ranluxstats(); }
+#endif
@@ -0,0 +1,112 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#include "ranluxstd.h"
+#include "mulmod.h"
+
+ranluxstd::ranluxstd(int w, int p, int r) : _w(w), _p(p), _r(r), _pos(r) {
+  for(int i=0;i<9;i++) _A[i] = ranluxpp::geta()[i];
+  powmod(_A, p*w/24);
+}
+
+// The base engine state with the long lag of 24 24-bit or 12 48-bit
+// numbers is the RANLUX sequence y[23] (the oldest) ... y[0] (the most
+// recent) of 24-bit numbers, a 48-bit number is a pair of the consecutive
+// 24-bit numbers with the most recent one in the upper half.
+void ranluxstd::setstate(const uint64_t *x, bool c){
+  uint32_t y[24];
+  const uint32_t mask = (1<<24)-1;
+  if(_w == 24){
+    for(int k=0;k<24;k++) y[23-k] = x[k] & mask;
+  } else {
+    for(int k=0;k<12;k++){
+      y[23-2*k] = x[k] & mask;
+      y[22-2*k] = (x[k]>>24) & mask;
+    }
+  }
+  getlcgstate(_x, y, c);
+
+  // step over the long lag to the state with the first block in its sequence
+  uint64_t a[9];
+  for(int i=0;i<9;i++) a[i] = ranluxpp::geta()[i];
+  powmod(a, 24);
+  mul9x9mod(_x, a);
+  unpack();
+  _pos = 0;
+}
+
+void ranluxstd::setstate(const uint32_t *a){
+  const int R = 24*24/_w, k = (_w+31)/32;
+  const uint64_t mask = (((uint64_t)1)<<_w) - 1;
+  uint64_t x[24];
+  for(int i=0;i<R;i++){
+    uint64_t sum = 0;
+    for(int j=0;j<k;j++) sum += (uint64_t)a[k*i + j]<<(32*j);
+    x[i] = sum & mask;
+  }
+  setstate(x, x[R-1] == 0);
+}
+
+void ranluxstd::seed(uint64_t value){
+  // std::linear_congruential_engine<uint_least32_t, 40014u, 0u, 2147483563u>
+  // seeded by value % 2147483563 (LWG 3809, 4014)
+  const uint64_t m = 2147483563u;
+  uint64_t s = (value ? value : 19780503u) % m;
+  if(!s) s = 1;
+  const int R = 24*24/_w, k = (_w+31)/32;
+  uint32_t a[24*2];
+  for(int i=0;i<R*k;i++){
+    s = (40014u*s) % m;
+    a[i] = s;
+  }
+  setstate(a);
+}
+
+void ranluxstd::unpack(){
+  uint32_t y[24];
+  getranluxseq(y, _x);
+  if(_w == 24){
+    for(int k=0;k<_r;k++) _y[k] = y[23-k];
+  } else {
+    for(int k=0;k<_r;k++) _y[k] = (uint64_t)y[22-2*k]<<24 | y[23-2*k];
+  }
+}
+
+void ranluxstd::nextblock(){
+  mul9x9mod(_x, _A);
+  unpack();
+  _pos = 0;
+}
+
+void ranluxstd::discard(unsigned long long z){
+  uint64_t rest = _r - _pos;
+  if(z < rest){
+    _pos += z;
+    return;
+  }
+  z -= rest; // the current block is exhausted
+  uint64_t A[9];
+  for(int i=0;i<9;i++) A[i] = _A[i];
+  powmod(A, z/_r + 1);
+  mul9x9mod(_x, A);
+  unpack();
+  _pos = z%_r;
+}
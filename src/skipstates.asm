@@ -147,3 +147,349 @@ _skipstates:
 
 	popregs
         ret
+
+/*
+Interleaved skipping of 2 or 4 independent generators with the state
+vectors following each other in memory, 24 32-bit numbers per generator.
+Every generator has its own carry chain kept in a byte register.
+In _skipstates2 the 24 steps x[i] = x[i+10] - x[i] - c (index modulo
+24, new x[i+10] for i < 14) of a state advance are done in four groups
+of 6 steps and the groups of the two generators alternate, so that
+their independent sbb chains are next to each other in the instruction
+stream and fill the ALU ports without a deep out-of-order window. A
+generator has 6 registers, a new number is kept in the register for the
+step 10 later where the registers allow it (6 of the 14), the other
+operands come from memory. The stores mask with and, which clobbers the
+flags, after the setc of the group.
+_skipstates4 does not have the registers for two interleaved pairs, it
+advances the generators one after the other in three groups of 8 steps
+with 8 registers and the chains overlap in the out-of-order engine
+only, which measured faster than swapping the carries of two pairs.
+*/
+
+.set  v0, %r8d
+.set  v1, %r9d
+.set  v2, %r10d
+.set  v3, %r11d
+.set  v4, %r12d
+.set  v5, %r13d
+.set  v6, %r14d
+.set  v7, %r15d
+.set  v8, %ebx
+.set  v9, %ecx
+.set  v10, %ebp
+.set  v11, %esi
+
+.macro ld j r o
+	mov 4*\j+\o(x), \r
+.endm
+
+.macro sb i r o
+	sbb 4*\i+\o(x), \r
+.endm
+
+.macro st r i o
+	and $0xffffff, \r
+	mov \r, 4*\i+\o(x)
+.endm
+
+// the sbb chains of the four groups of the generator at the offset o
+.macro sbbs1 o r0 r1 r2 r3 r4 r5
+	ld  9 \r0 \o
+	sb 23 \r0 \o
+	ld  8 \r1 \o
+	sb 22 \r1 \o
+	ld  7 \r2 \o
+	sb 21 \r2 \o
+	ld  6 \r3 \o
+	sb 20 \r3 \o
+	ld  5 \r4 \o
+	sb 19 \r4 \o
+	ld  4 \r5 \o
+	sb 18 \r5 \o
+.endm
+
+.macro sbbs2 o r0 r1 r2 r3 r4 r5
+	ld  3 \r5 \o
+	sb 17 \r5 \o
+	ld  2 \r4 \o
+	sb 16 \r4 \o
+	ld  1 \r3 \o
+	sb 15 \r3 \o
+	ld  0 \r2 \o
+	sb 14 \r2 \o
+	sb 13 \r0 \o
+	sb 12 \r1 \o
+.endm
+
+.macro sbbs3 o r0 r1 r2 r3 r4 r5
+	ld 21 \r1 \o
+	sb 11 \r1 \o
+	ld 20 \r0 \o
+	sb 10 \r0 \o
+	ld 19 \r2 \o
+	sb  9 \r2 \o
+	ld 18 \r3 \o
+	sb  8 \r3 \o
+	sb  7 \r5 \o
+	sb  6 \r4 \o
+.endm
+
+.macro sbbs4 o r0 r1 r2 r3 r4 r5
+	ld 15 \r2 \o
+	sb  5 \r2 \o
+	ld 14 \r3 \o
+	sb  4 \r3 \o
+	ld 13 \r4 \o
+	sb  3 \r4 \o
+	ld 12 \r5 \o
+	sb  2 \r5 \o
+	sb  1 \r1 \o
+	sb  0 \r0 \o
+.endm
+
+// the stores of the groups
+.macro sts1 o r0 r1 r2 r3 r4 r5
+	st \r0 23 \o
+	st \r1 22 \o
+	st \r2 21 \o
+	st \r3 20 \o
+	st \r4 19 \o
+	st \r5 18 \o
+.endm
+
+.macro sts2 o r0 r1 r2 r3 r4 r5
+	st \r5 17 \o
+	st \r4 16 \o
+	st \r3 15 \o
+	st \r2 14 \o
+	st \r0 13 \o
+	st \r1 12 \o
+.endm
+
+.macro sts3 o r0 r1 r2 r3 r4 r5
+	st \r1 11 \o
+	st \r0 10 \o
+	st \r2  9 \o
+	st \r3  8 \o
+	st \r5  7 \o
+	st \r4  6 \o
+.endm
+
+.macro sts4 o r0 r1 r2 r3 r4 r5
+	st \r2  5 \o
+	st \r3  4 \o
+	st \r4  3 \o
+	st \r5  2 \o
+	st \r1  1 \o
+	st \r0  0 \o
+.endm
+
+// advance the states of the generators at the offsets a and b with the
+// carries ca and cb by one state
+.macro swbpair a ca b cb
+	.irp g, 1, 2, 3, 4
+	add $0xff, \ca
+	sbbs\g \a v0 v1 v2 v3 v4 v5
+	setc \ca
+	add $0xff, \cb
+	sbbs\g \b v6 v7 v8 v9 v10 v11
+	setc \cb
+	sts\g \a v0 v1 v2 v3 v4 v5
+	sts\g \b v6 v7 v8 v9 v10 v11
+	.endr
+.endm
+
+// advance the state of the generator at the offset o by one state
+.macro swbstate o c
+	add $0xff, \c
+	ld 9 v0 \o
+	sb 23 v0 \o
+	ld 8 v1 \o
+	sb 22 v1 \o
+	ld 7 v2 \o
+	sb 21 v2 \o
+	ld 6 v3 \o
+	sb 20 v3 \o
+	ld 5 v4 \o
+	sb 19 v4 \o
+	ld 4 v5 \o
+	sb 18 v5 \o
+	ld 3 v6 \o
+	sb 17 v6 \o
+	ld 2 v7 \o
+	sb 16 v7 \o
+	setc \c
+	st v0 23 \o
+	st v1 22 \o
+	st v2 21 \o
+	st v3 20 \o
+	st v4 19 \o
+	st v5 18 \o
+	st v6 17 \o
+	st v7 16 \o
+
+	add $0xff, \c
+	ld 1 v6 \o
+	sb 15 v6 \o
+	ld 0 v7 \o
+	sb 14 v7 \o
+	sb 13 v0 \o
+	sb 12 v1 \o
+	sb 11 v2 \o
+	sb 10 v3 \o
+	sb  9 v4 \o
+	sb  8 v5 \o
+	setc \c
+	st v6 15 \o
+	st v7 14 \o
+	st v0 13 \o
+	st v1 12 \o
+	st v2 11 \o
+	st v3 10 \o
+	st v4  9 \o
+	st v5  8 \o
+
+	add $0xff, \c
+	ld 17 v4 \o
+	sb  7 v4 \o
+	ld 16 v5 \o
+	sb  6 v5 \o
+	sb  5 v6 \o
+	sb  4 v7 \o
+	sb  3 v0 \o
+	sb  2 v1 \o
+	sb  1 v2 \o
+	sb  0 v3 \o
+	setc \c
+	st v4  7 \o
+	st v5  6 \o
+	st v6  5 \o
+	st v7  4 \o
+	st v0  3 \o
+	st v1  2 \o
+	st v2  1 \o
+	st v3  0 \o
+.endm
+
+/*
+void _skipstates2(uint32_t *state, uint32_t *carry, uint64_t nskip);
+void _skipstates4(uint32_t *state, uint32_t *carry, uint64_t nskip);
+x=state=%rdi, carry=%rsi, n=nskip=%rdx; in _skipstates2 the carries are
+in %al and %dl, the carry pointer and n are on the stack
+*/
+	.globl _skipstates2
+_skipstates2:
+	pushregs
+	push %rsi
+	push n
+
+	mov 0(%rsi), %al
+	mov 4(%rsi), %dl
+.L2:
+	swbpair 0 %al 96 %dl
+	decq (%rsp)
+	jnz .L2
+	add $8, %rsp
+	pop %rsi
+	mov %al, 0(%rsi)
+	mov %dl, 4(%rsi)
+
+	popregs
+        ret
+
+	.globl _skipstates4
+_skipstates4:
+	pushregs
+
+	mov  0(%rsi), %al
+	mov  4(%rsi), %bl
+	mov  8(%rsi), %cl
+	mov 12(%rsi), %bpl
+.L4:
+	swbstate   0 %al
+	swbstate  96 %bl
+	swbstate 192 %cl
+	swbstate 288 %bpl
+	dec n
+	jnz .L4
+	mov %al,   0(%rsi)
+	mov %bl,   4(%rsi)
+	mov %cl,   8(%rsi)
+	mov %bpl, 12(%rsi)
+
+	popregs
+        ret
+
+/*
+Skipping of the generator with the base 2^48 and the lags r = 12, s = 5,
+the state vector of 12 64-bit numbers is advanced in three groups of
+5, 5 and 2 steps, the new numbers of a group are kept in registers for
+the next one.
+
+unsigned char _skipstates48(uint64_t *state, unsigned char carry, uint64_t nskip);
+x=state=%rdi, c=carry=%rsi, n=nskip=%rdx
+*/
+
+.set  q0, %rax
+.set  q1, %rcx
+.set  q2, %r8
+.set  q3, %r9
+.set  q4, %r10
+.set  m48, %r11
+
+.macro step48 i j r
+	mov 8*\j(x), \r
+	sbb 8*\i(x), \r
+.endm
+
+.macro step48s i r
+	sbb 8*\i(x), \r
+.endm
+
+.macro store48 r i
+	and m48, \r
+	mov \r, 8*\i(x)
+.endm
+
+	.globl _skipstates48
+_skipstates48:
+	mov $0xffffffffffff, m48
+.L48:
+	add $0xff, c
+	step48 11 4 q0
+	step48 10 3 q1
+	step48  9 2 q2
+	step48  8 1 q3
+	step48  7 0 q4
+	setc c
+	store48 q0 11
+	store48 q1 10
+	store48 q2  9
+	store48 q3  8
+	store48 q4  7
+
+	add $0xff, c
+	step48s 6 q0
+	step48s 5 q1
+	step48s 4 q2
+	step48s 3 q3
+	step48s 2 q4
+	setc c
+	store48 q0 6
+	store48 q1 5
+	store48 q2 4
+	store48 q3 3
+	store48 q4 2
+
+	add $0xff, c
+	step48s 1 q0
+	step48s 0 q1
+	setc c
+	store48 q0 1
+	store48 q1 0
+	dec n
+	jnz .L48
+
+	movzbl c, %eax
+        ret
@@ -0,0 +1,336 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#include "bench.h"
+#include "cpuarch.h"
+#include <sys/utsname.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+
+benchopts opts;
+perfcounters *perf = NULL;
+volatile double benchsink;
+
+double tscghz(){
+  using namespace std::chrono;
+  static double f = 0;
+  if(f == 0){
+    // the best of a few 20 ms intervals
+    for(int i=0;i<3;i++){
+      auto t0 = steady_clock::now();
+      uint64_t c0 = rdtsc();
+      while(duration<double>(steady_clock::now() - t0).count() < 0.02);
+      uint64_t c1 = rdtsc();
+      double dt = duration<double, std::nano>(steady_clock::now() - t0).count();
+      double fi = (c1 - c0)/dt;
+      if(f == 0 || fi < f) f = fi;
+    }
+  }
+  return f;
+}
+
+bool pincpu(int cpu){
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+benchstats::benchstats(const std::vector<double> &v) : mean(0), sd(0), min(0), max(0) {
+  if(v.empty()) return;
+  min = max = v[0];
+  for(double x : v){
+    mean += x;
+    if(x < min) min = x;
+    if(x > max) max = x;
+  }
+  mean /= v.size();
+  for(double x : v) sd += (x - mean)*(x - mean);
+  if(v.size() > 1) sd = sqrt(sd/(v.size() - 1));
+}
+
+histogram::histogram() : _n((64 - S + 1) << S), _count(0), _max(0), _sum(0) {}
+
+int histogram::bucket(uint64_t v){
+  if(v < (1u<<S)) return v;
+  int e = 63 - __builtin_clzll(v);
+  return (e - S + 1)<<S | ((v>>(e - S)) & ((1u<<S) - 1));
+}
+
+uint64_t histogram::lowest(int b){
+  if(b < (1<<S)) return b;
+  int e = (b>>S) + S - 1;
+  return (uint64_t)((1<<S) | (b & ((1<<S) - 1)))<<(e - S);
+}
+
+void histogram::add(uint64_t v){
+  _n[bucket(v)]++;
+  _count++;
+  _sum += v;
+  if(v > _max) _max = v;
+}
+
+uint64_t histogram::percentile(double q) const {
+  uint64_t k = (uint64_t)ceil(q*_count), c = 0;
+  if(k == 0) k = 1;
+  for(size_t b=0;b<_n.size();b++){
+    c += _n[b];
+    if(c >= k){
+      uint64_t v = (b + 1 < _n.size()) ? lowest(b + 1) - 1 : _max;
+      return v < _max ? v : _max;
+    }
+  }
+  return _max;
+}
+
+static std::string quote(const char *s){
+  std::string r = "\"";
+  for(; *s; s++){
+    if(*s == '"' || *s == '\\') r += '\\';
+    if((unsigned char)*s < 0x20) continue;
+    r += *s;
+  }
+  return r + "\"";
+}
+
+static std::string number(double v){
+  if(!isfinite(v)) return "null";
+  char b[32];
+  snprintf(b, sizeof(b), "%.6g", v);
+  return b;
+}
+
+jsonobj &jsonobj::add(const char *key, double v){
+  _items.emplace_back(key, number(v));
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, int v){
+  _items.emplace_back(key, std::to_string(v));
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, uint64_t v){
+  _items.emplace_back(key, std::to_string(v));
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, const char *v){
+  _items.emplace_back(key, quote(v));
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, const jsonobj &v){
+  _items.emplace_back(key, v.str());
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, const std::vector<double> &v){
+  std::string s = "[";
+  for(size_t i=0;i<v.size();i++) s += (i ? ", " : "") + number(v[i]);
+  _items.emplace_back(key, s + "]");
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, const std::vector<jsonobj> &v){
+  std::string s = "[";
+  for(size_t i=0;i<v.size();i++) s += (i ? ",\n  " : "\n  ") + v[i].str();
+  _items.emplace_back(key, s + "\n]");
+  return *this;
+}
+
+jsonobj &jsonobj::add(const char *key, const benchstats &s){
+  jsonobj o;
+  o.add("mean", s.mean).add("sd", s.sd).add("min", s.min).add("max", s.max);
+  return add(key, o);
+}
+
+bool jsonobj::has(const char *key) const {
+  for(auto &i : _items) if(i.first == key) return true;
+  return false;
+}
+
+std::string jsonobj::str() const {
+  std::string s = "{";
+  for(size_t i=0;i<_items.size();i++)
+    s += (i ? ", " : "") + quote(_items[i].first.c_str()) + ": " + _items[i].second;
+  return s + "}";
+}
+
+static std::string cpumodel(){
+  std::string model = "unknown";
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  if(f){
+    char line[512];
+    while(fgets(line, sizeof(line), f)){
+      if(strncmp(line, "model name", 10)) continue;
+      char *p = strchr(line, ':');
+      if(!p) continue;
+      for(p++; *p == ' '; p++);
+      p[strcspn(p, "\n")] = 0;
+      model = p;
+      break;
+    }
+    fclose(f);
+  }
+  return model;
+}
+
+std::string hostkey(){
+  return cpumodel();
+}
+
+std::string kernelrelease(){
+  struct utsname u;
+  return uname(&u) ? "unknown" : u.release;
+}
+
+jsonobj hostinfo(){
+  jsonobj o;
+  std::string model = cpumodel();
+  struct utsname u;
+  o.add("cpu", model).add("arch", getarch());
+  if(!uname(&u)) o.add("kernel", u.release).add("machine", u.machine);
+  o.add("compiler", __VERSION__).add("tsc_ghz", tscghz());
+  if(opts.perf) o.add("perf_counters", perf ? perf->names() : std::string(""));
+  if(perf && perf->status() != "ok") o.add("perf_failed", perf->status());
+  return o;
+}
+
+bool selected(const std::string &name){
+  return !opts.filter || name.find(opts.filter) != std::string::npos;
+}
+
+void perfcounters::open(const char *name, uint32_t type, uint64_t config){
+  perf_event_attr a;
+  memset(&a, 0, sizeof(a));
+  a.size = sizeof(a);
+  a.type = type;
+  a.config = config;
+  a.disabled = 1;
+  a.exclude_kernel = 1;
+  a.exclude_hv = 1;
+  a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  int fd = syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+  if(fd < 0){
+    _failed.push_back({name, errno});
+    return;
+  }
+  _c.push_back({name, fd});
+}
+
+perfcounters::perfcounters(const char *raw){
+  const uint64_t l1dmiss = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ<<8
+    | PERF_COUNT_HW_CACHE_RESULT_MISS<<16;
+  const uint64_t llcmiss = PERF_COUNT_HW_CACHE_LL | PERF_COUNT_HW_CACHE_OP_READ<<8
+    | PERF_COUNT_HW_CACHE_RESULT_MISS<<16;
+  open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  open("branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  open("L1D-read-misses", PERF_TYPE_HW_CACHE, l1dmiss);
+  open("LLC-read-misses", PERF_TYPE_HW_CACHE, llcmiss);
+  open("context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+  // name=config pairs separated by commas
+  std::string r = raw ? raw : "";
+  for(size_t b = 0; b < r.size();){
+    size_t e = r.find(',', b);
+    if(e == std::string::npos) e = r.size();
+    std::string item = r.substr(b, e - b);
+    size_t q = item.find('=');
+    if(q != std::string::npos)
+      open(item.substr(0, q).c_str(), PERF_TYPE_RAW, strtoull(item.c_str() + q + 1, NULL, 0));
+    else
+      fprintf(stderr, "Raw event %s is not name=config, ignored.\n", item.c_str());
+    b = e + 1;
+  }
+}
+
+perfcounters::~perfcounters(){
+  for(auto &c : _c) close(c.fd);
+}
+
+std::string perfcounters::status() const {
+  std::string s;
+  for(auto &f : _failed) s += (s.empty() ? "" : ", ") + f.name + ": " + strerror(f.err);
+  return s.empty() ? "ok" : s;
+}
+
+std::string perfcounters::names() const {
+  std::string s;
+  for(auto &c : _c) s += (s.empty() ? "" : ",") + c.name;
+  return s;
+}
+
+void perfcounters::reset(){
+  for(auto &c : _c) ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+}
+
+void perfcounters::start(){
+  for(auto &c : _c) ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void perfcounters::stop(){
+  for(auto &c : _c) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+// the count scaled for the time the counter was multiplexed out, -1 if
+// the counter has not run at all
+static double perfread(int fd){
+  uint64_t v[3];
+  if(read(fd, v, sizeof(v)) != sizeof(v) || v[2] == 0) return -1;
+  return (double)v[0]*v[1]/v[2];
+}
+
+jsonobj perfcounters::report(double n) const {
+  jsonobj o;
+  double cycles = -1, instructions = -1;
+  for(auto &c : _c){
+    double v = perfread(c.fd);
+    if(c.name == "cycles") cycles = v;
+    if(c.name == "instructions") instructions = v;
+    o.add(c.name.c_str(), v < 0 ? NAN : v/n);
+  }
+  if(cycles > 0 && instructions >= 0) o.add("ipc", instructions/cycles);
+  return o;
+}
+
+std::string perfcounters::summary(double n) const {
+  std::string s;
+  char b[128];
+  double cycles = -1, instructions = -1;
+  for(auto &c : _c){
+    double v = perfread(c.fd);
+    if(c.name == "cycles") cycles = v;
+    if(c.name == "instructions") instructions = v;
+    if(v < 0) snprintf(b, sizeof(b), "%s%s n/a", s.empty() ? "" : ", ", c.name.c_str());
+    else snprintf(b, sizeof(b), "%s%s %.4g", s.empty() ? "" : ", ", c.name.c_str(), v/n);
+    s += b;
+  }
+  if(cycles > 0 && instructions >= 0){
+    snprintf(b, sizeof(b), ", IPC %.2f", instructions/cycles);
+    s += b;
+  }
+  return s + " per number";
+}
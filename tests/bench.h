@@ -0,0 +1,260 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Common pieces of the benchmark suites: the time stamp counter, CPU    *
+ * pinning, statistics of repeated runs and a minimal JSON builder.      *
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+
+// the time stamp counter, inline asm since __rdtsc does not inline into
+// functions with the target attributes of the multiversioned kernels
+static inline uint64_t rdtsc(){
+  uint32_t lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return (uint64_t)hi<<32 | lo;
+}
+
+// the time stamp counter read after the preceding instructions retire
+static inline uint64_t rdtscp(){
+  uint32_t lo, hi, aux;
+  asm volatile("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+  return (uint64_t)hi<<32 | lo;
+}
+
+// time stamp counter ticks per ns measured against the steady clock
+double tscghz();
+
+// pin the calling thread to the cpu, returns false if not permitted
+bool pincpu(int cpu);
+
+// mean, standard deviation, minimum and maximum of repeated measurements
+struct benchstats {
+  double mean, sd, min, max;
+  benchstats(const std::vector<double> &v);
+};
+
+// JSON object with the members in the order of insertion
+class jsonobj {
+  std::vector<std::pair<std::string, std::string>> _items;
+public:
+  jsonobj &add(const char *key, double v);
+  jsonobj &add(const char *key, int v);
+  jsonobj &add(const char *key, uint64_t v);
+  jsonobj &add(const char *key, const char *v);
+  jsonobj &add(const char *key, const std::string &v) { return add(key, v.c_str()); }
+  jsonobj &add(const char *key, const jsonobj &v);
+  jsonobj &add(const char *key, const std::vector<double> &v);
+  jsonobj &add(const char *key, const std::vector<jsonobj> &v);
+  jsonobj &add(const char *key, const benchstats &s);
+  bool has(const char *key) const;
+  std::string str() const;
+};
+
+// HDR style histogram of non-negative integers: the values below 2^S are
+// counted exactly, above every power of two is split into 2^S linear
+// sub-buckets, i.e. the relative resolution is 2^-S
+class histogram {
+  static const int S = 5;
+  std::vector<uint64_t> _n;
+  uint64_t _count, _max;
+  double _sum;
+  static int bucket(uint64_t v);
+  static uint64_t lowest(int b); // the lowest value of the bucket b
+public:
+  histogram();
+  void add(uint64_t v);
+  uint64_t count() const { return _count; }
+  uint64_t max() const { return _max; }
+  double mean() const { return _count ? _sum/_count : 0; }
+  // the highest value equivalent within the resolution to the value at
+  // the quantile q
+  uint64_t percentile(double q) const;
+};
+
+// Hardware performance counters of the calling thread via perf_event_open:
+// cycles, instructions, branch misses, L1D and LLC read misses, context
+// switches and optional raw events, e.g. micro-op port events, given as
+// "name=0xconfig,...". The counters which can not be opened (no PMU, not
+// permitted by perf_event_paranoid) are dropped, if none is left nothing
+// is reported.
+class perfcounters {
+  struct counter {
+    std::string name;
+    int fd;
+  };
+  std::vector<counter> _c;
+  struct failure {
+    std::string name;
+    int err;
+  };
+  std::vector<failure> _failed; // the counters which could not be opened and why
+  void open(const char *name, uint32_t type, uint64_t config);
+public:
+  perfcounters(const char *raw = NULL);
+  ~perfcounters();
+  bool available() const { return !_c.empty(); }
+  std::string status() const; // "ok" or the name and error of every failed counter
+  std::string names() const; // the opened counters
+  void reset();   // zero the counters
+  void start();   // count from here
+  void stop();    // up to here, counts accumulate over start/stop pairs
+  // the counts per number and the instructions per cycle
+  jsonobj report(double n) const;
+  std::string summary(double n) const;
+};
+extern perfcounters *perf;
+
+// options shared by the suites
+struct benchopts {
+  int repeat = 5;             // timed runs of every benchmark
+  double time = 0.2;          // seconds per run
+  int cpu = -2;               // cpu to pin to, -1 -- no pinning, -2 -- the current one
+  const char *filter = NULL;  // run the benchmarks with the substring in the name only
+  const char *json = NULL;    // JSON output file, "-" -- stdout
+  bool perf = false;          // collect the hardware performance counters
+  const char *perfraw = NULL; // additional raw events
+  const char *threads = NULL; // thread counts of the scaling suite, "1,2,4"
+  const char *pinning = "cores"; // cores, smt, sockets or none
+  const char *baseline = "bench_baseline.txt"; // the baseline file
+  bool save = false;          // store the results as the baseline
+  bool compare = false;       // compare the results with the baseline
+  double tolerance = 0.05;    // relative slowdown tolerated by the comparison
+  const char *sweepp = NULL;  // luxury values of the sweep, "24,48,..."
+  const char *sweepblock = NULL; // getarray block sizes of the sweep, "1,10,..."
+  const char *csv = NULL;     // CSV output file of the sweep, "-" -- stdout
+};
+extern benchopts opts;
+
+// description of the host: CPU model, kernel, compiler, TSC frequency
+jsonobj hostinfo();
+
+// the cpus in the order the threads are pinned to by the pinning policy
+// cores, smt, sockets or none
+std::vector<int> cpuorder(const char *policy);
+
+// the thread counts given by --threads, by default the powers of 2 up to
+// the number of cpus and the number of cpus
+std::vector<int> threadcounts(int ncpu);
+
+// does the benchmark name pass the filter
+bool selected(const std::string &name);
+
+// the cycles per number of a measured benchmark kept for the comparison
+// with the baseline, id is "name type api"
+struct benchresult {
+  std::string id;
+  double mean, sd;
+  int n;
+};
+extern std::vector<benchresult> benchresults;
+
+// the key of the host in the baseline file: the CPU model
+std::string hostkey();
+
+// the kernel release, recorded with a baseline for information
+std::string kernelrelease();
+
+// Store the results of this run in the baseline file under the host key,
+// the entries of other hosts and other benchmarks are kept.
+bool savebaseline(const char *file);
+
+// Compare the results of this run with the baseline of the host and print
+// a report. A benchmark regresses if the 95% confidence interval of the
+// difference of the means lies above tolerance*baseline. Returns the
+// number of regressions, -1 if there is no baseline for the host.
+int comparebaseline(const char *file, double tolerance);
+
+// the suites
+void bench_engines(std::vector<jsonobj> &res);
+void bench_kernels(std::vector<jsonobj> &res);
+void bench_latency(std::vector<jsonobj> &res);
+void bench_scaling(std::vector<jsonobj> &res);
+void bench_reference(std::vector<jsonobj> &res);
+void bench_sweep(std::vector<jsonobj> &res);
+void bench_setup(std::vector<jsonobj> &res);
+void bench_roofline(std::vector<jsonobj> &res);
+
+// the checksums of the measured runs go here to keep them alive
+extern volatile double benchsink;
+
+// Time f(n), which produces n numbers and returns their checksum: after a
+// warm-up run sizing n to the requested run time, opts.repeat runs are
+// done. Reported are TSC cycles, ns and GB/s (bits of randomness per
+// number) per run statistics, GB/s is omitted for bits = 0. If f works in
+// blocks n is a multiple of the granularity.
+template<class F>
+jsonobj measure(const std::string &name, const char *type, const char *api,
+		double bits, F f, size_t granularity = 1){
+  using namespace std::chrono;
+  size_t n = 256 < granularity ? granularity : 256;
+  double t = 0;
+  for(;;){
+    auto t0 = steady_clock::now();
+    benchsink = f(n);
+    t = duration<double>(steady_clock::now() - t0).count();
+    if(t > 0.1*opts.time || n > ((size_t)1<<40)) break;
+    n *= 4;
+  }
+  n = (size_t)(n*opts.time/t) + 1;
+  n = (n + granularity - 1)/granularity*granularity;
+  std::vector<double> cyc, ns, gbs;
+  if(perf) perf->reset();
+  for(int r=0;r<opts.repeat;r++){
+    if(perf) perf->start();
+    auto t0 = steady_clock::now();
+    uint64_t c0 = rdtsc();
+    benchsink = f(n);
+    uint64_t c1 = rdtsc();
+    if(perf) perf->stop();
+    double dt = duration<double, std::nano>(steady_clock::now() - t0).count();
+    cyc.push_back((double)(c1 - c0)/n);
+    ns.push_back(dt/n);
+    gbs.push_back(n*bits/8/dt);
+  }
+  jsonobj o;
+  o.add("name", name).add("type", type).add("api", api).add("bits", bits)
+    .add("numbers", (uint64_t)n).add("repeat", opts.repeat)
+    .add("cycles_per_number", benchstats(cyc))
+    .add("ns_per_number", benchstats(ns));
+  if(bits > 0) o.add("gb_per_s", benchstats(gbs));
+  if(perf) o.add("counters", perf->report((double)n*opts.repeat));
+  benchstats s(cyc);
+  benchresults.push_back({name + " " + type + " " + api, s.mean, s.sd, opts.repeat});
+  printf("%-36s %-7s %-10s %9.2f +- %-6.2f cycles %8.2f ns", name.c_str(), type, api,
+	 s.mean, s.sd, benchstats(ns).mean);
+  if(bits > 0) printf(" %7.3f GB/s", benchstats(gbs).mean);
+  printf("\n");
+  if(perf) printf("    %s\n", perf->summary((double)n*opts.repeat).c_str());
+  fflush(stdout);
+  return o;
+}
@@ -0,0 +1,156 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Performance regression gate: the cycles per number of the measured    *
+ * benchmarks are stored per host in a plain text baseline file          *
+ *                                                                       *
+ *   [CPU model]                                                         *
+ *   @kernel release                                                     *
+ *   @compiler version                                                   *
+ *   mean sd runs benchmark name                                         *
+ *                                                                       *
+ * and later runs are compared with it. A different kernel or compiler   *
+ * than the baseline was measured with is reported, not a missing one.   *
+ *************************************************************************/
+
+#include "bench.h"
+#include <map>
+
+std::vector<benchresult> benchresults;
+
+struct hostbaseline {
+  std::string kernel, compiler;            // the system the baseline was measured on
+  std::map<std::string, benchresult> results;
+};
+
+static std::map<std::string, hostbaseline> readbaseline(const char *file){
+  std::map<std::string, hostbaseline> b;
+  FILE *f = fopen(file, "r");
+  if(!f) return b;
+  char line[1024];
+  hostbaseline *h = NULL;
+  while(fgets(line, sizeof(line), f)){
+    line[strcspn(line, "\n")] = 0;
+    if(line[0] == '#' || line[0] == 0) continue;
+    if(line[0] == '['){
+      char *e = strrchr(line, ']');
+      if(e) *e = 0;
+      h = &b[line + 1];
+      continue;
+    }
+    if(h && !strncmp(line, "@kernel ", 8)){ h->kernel = line + 8; continue; }
+    if(h && !strncmp(line, "@compiler ", 10)){ h->compiler = line + 10; continue; }
+    benchresult r;
+    int k = 0;
+    if(!h || sscanf(line, "%lf %lf %d %n", &r.mean, &r.sd, &r.n, &k) != 3 || !line[k]) continue;
+    r.id = line + k;
+    h->results[r.id] = r;
+  }
+  fclose(f);
+  return b;
+}
+
+bool savebaseline(const char *file){
+  std::map<std::string, hostbaseline> b = readbaseline(file);
+  hostbaseline &h = b[hostkey()];
+  h.kernel = kernelrelease();
+  h.compiler = __VERSION__;
+  for(auto &r : benchresults) h.results[r.id] = r;
+  FILE *f = fopen(file, "w");
+  if(!f){
+    perror(file);
+    return false;
+  }
+  fprintf(f, "# ranlux_bench baseline: cycles per number mean, sd, runs, benchmark\n");
+  for(auto &i : b){
+    fprintf(f, "[%s]\n", i.first.c_str());
+    if(!i.second.kernel.empty()) fprintf(f, "@kernel %s\n", i.second.kernel.c_str());
+    if(!i.second.compiler.empty()) fprintf(f, "@compiler %s\n", i.second.compiler.c_str());
+    for(auto &j : i.second.results)
+      fprintf(f, "%.6g %.6g %d %s\n", j.second.mean, j.second.sd, j.second.n, j.first.c_str());
+  }
+  fclose(f);
+  printf("Baseline of %d benchmarks for %s stored in %s\n", (int)benchresults.size(),
+	 hostkey().c_str(), file);
+  return true;
+}
+
+// the 0.975 quantile of the Student t distribution
+static double t975(double df){
+  static const double t[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+			     2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+			     2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+			     2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  int k = (int)df;
+  if(k < 1) k = 1;
+  return k <= 30 ? t[k - 1] : 1.96;
+}
+
+int comparebaseline(const char *file, double tolerance){
+  std::map<std::string, hostbaseline> b = readbaseline(file);
+  std::string key = hostkey();
+  auto hi = b.find(key);
+  if(hi == b.end()){
+    printf("No baseline for %s in %s, run with --save-baseline first.\n", key.c_str(), file);
+    return -1;
+  }
+  const hostbaseline &h = hi->second;
+  if(!h.kernel.empty() && h.kernel != kernelrelease())
+    printf("Warning: the baseline was measured with the kernel %s, this is %s.\n", h.kernel.c_str(),
+	   kernelrelease().c_str());
+  if(!h.compiler.empty() && h.compiler != __VERSION__)
+    printf("Warning: the baseline was built with the compiler %s, this is %s.\n", h.compiler.c_str(),
+	   __VERSION__);
+  int nreg = 0;
+  printf("\nComparison with the baseline %s for %s, tolerance %g%%\n", file, key.c_str(),
+	 100*tolerance);
+  printf("%-48s %9s %9s %8s %17s  %s\n", "benchmark", "baseline", "current", "change",
+	 "95% CI", "verdict");
+  for(auto &c : benchresults){
+    auto bi = h.results.find(c.id);
+    if(bi == h.results.end()){
+      printf("%-48s %9s %9.2f %8s %17s  new\n", c.id.c_str(), "-", c.mean, "", "");
+      continue;
+    }
+    const benchresult &r = bi->second;
+    // Welch's interval of the difference of the means
+    double vb = r.sd*r.sd/r.n, vc = c.sd*c.sd/c.n, se = sqrt(vb + vc);
+    double df = 1e9;
+    if(se > 0){
+      double d = (r.n > 1 ? vb*vb/(r.n - 1) : 0) + (c.n > 1 ? vc*vc/(c.n - 1) : 0);
+      if(d > 0) df = (vb + vc)*(vb + vc)/d;
+    }
+    double diff = c.mean - r.mean, w = t975(df)*se;
+    const char *verdict = "ok";
+    if(diff - w > tolerance*r.mean){
+      verdict = "REGRESSION";
+      nreg++;
+    } else if(diff + w < -tolerance*r.mean) verdict = "faster";
+    char ci[32];
+    snprintf(ci, sizeof(ci), "[%+.1f%%, %+.1f%%]", 100*(diff - w)/r.mean, 100*(diff + w)/r.mean);
+    printf("%-48s %9.2f %9.2f %+7.1f%% %17s  %s\n", c.id.c_str(), r.mean, c.mean,
+	   100*diff/r.mean, ci, verdict);
+  }
+  if(nreg) printf("%d benchmark(s) regressed beyond %g%% of the baseline.\n", nreg, 100*tolerance);
+  else printf("No regressions.\n");
+  return nreg;
+}
@@ -0,0 +1,144 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Microbenchmarks of the assembly kernels. Every kernel is timed per    *
+ * call in two ways: latency -- each call takes the output of the        *
+ * previous one, throughput -- K independent chains are interleaved so   *
+ * that the calls overlap in the out-of-order engine.                    *
+ *************************************************************************/
+
+#include "bench.h"
+#include <cpuid.h>
+#include <random>
+
+extern "C" {
+  void _mul9x9_mul(uint64_t *b, const uint64_t *a);
+  void _remainder(uint64_t *b);
+  void _mul9x9_mulx(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9_mulxadox(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9mod_mulx(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9mod_mulxadox(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _divmult(uint64_t y[18], const uint64_t x[9]);
+#ifdef ASMSKIP
+  unsigned char _skipstates(uint32_t *state, unsigned char carry, uint64_t nskip);
+  void _skipstates2(uint32_t *state, uint32_t *carry, uint64_t nskip);
+  void _skipstates4(uint32_t *state, uint32_t *carry, uint64_t nskip);
+  unsigned char _skipstates48(uint64_t *state, unsigned char carry, uint64_t nskip);
+#endif
+};
+
+// independent chains in the throughput mode
+static const int K = 8;
+
+// the multiplier and per chain two buffers the calls alternate between,
+// the first limb of a buffer is the zero guard limb needed by _divmult,
+// a chain has room for the states of 4 conventional RANLUX generators
+alignas(64) static uint64_t A[9];
+alignas(64) static uint64_t S[K][2][24];
+static uint32_t C[K][4];
+
+// random words of the width given by mask
+static void fillbuffers(uint64_t mask){
+  std::mt19937_64 r(3124);
+  for(int i=0;i<9;i++) A[i] = r();
+  for(int j=0;j<K;j++){
+    for(int k=0;k<2;k++)
+      for(int i=0;i<24;i++) S[j][k][i] = r() & mask;
+    S[j][0][0] = S[j][1][0] = 0;
+    for(int i=0;i<4;i++) C[j][i] = 0;
+  }
+}
+
+// extended instructions used by the kernels, CPUID leaf 7
+static bool cpuhas(int bit){
+  unsigned a, b, c, d;
+  if(!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+  return (b>>bit)&1;
+}
+
+// step(j, i) does the i-th call of the chain j, the buffers hold full
+// 64 bit limbs unless mask limits them to the words of the kernel
+template<class F>
+static void bench_kernel(std::vector<jsonobj> &res, const char *name, F step, uint64_t mask = ~0UL){
+  fillbuffers(mask);
+  if(selected(std::string(name) + " call latency"))
+    res.push_back(measure(name, "call", "latency", 0, [&step](size_t n){
+	  for(size_t i=0;i<n;i++) step(0, i);
+	  return (double)S[0][0][1];
+	}));
+  if(selected(std::string(name) + " call throughput"))
+    res.push_back(measure(name, "call", "throughput", 0, [&step](size_t n){
+	  for(size_t i=0;i<n;i+=K)
+	    for(int j=0;j<K;j++) step(j, i/K);
+	  return (double)S[0][0][1];
+	}));
+}
+
+// the output buffer of the i-th call is the input of the next one
+#define IN(j, i) (S[j][(i)&1] + 1)
+#define OUT(j, i) (S[j][~(i)&1] + 1)
+
+void bench_kernels(std::vector<jsonobj> &res){
+  const bool bmi2 = cpuhas(8), adx = cpuhas(19);
+
+  // 576x576 -> 1152 bit product in place
+  bench_kernel(res, "_mul9x9_mul", [](int j, size_t){ _mul9x9_mul(IN(j, 0), A); });
+  if(bmi2)
+    bench_kernel(res, "_mul9x9_mulx", [](int j, size_t i){ _mul9x9_mulx(OUT(j, i), A, IN(j, i)); });
+  if(bmi2 && adx)
+    bench_kernel(res, "_mul9x9_mulxadox", [](int j, size_t i){ _mul9x9_mulxadox(OUT(j, i), A, IN(j, i)); });
+
+  // 1152 bit number modulo 2^576 - 2^240 + 1 in place
+  bench_kernel(res, "_remainder", [](int j, size_t){ _remainder(IN(j, 0)); });
+
+  // modular multiplication
+  bench_kernel(res, "_mul9x9_mul+_remainder", [](int j, size_t){
+      _mul9x9_mul(IN(j, 0), A);
+      _remainder(IN(j, 0));
+    });
+  if(bmi2)
+    bench_kernel(res, "_mul9x9mod_mulx", [](int j, size_t i){ _mul9x9mod_mulx(OUT(j, i), A, IN(j, i)); });
+  if(bmi2 && adx)
+    bench_kernel(res, "_mul9x9mod_mulxadox", [](int j, size_t i){ _mul9x9mod_mulxadox(OUT(j, i), A, IN(j, i)); });
+
+  // LCG state to the RANLUX sequence, the guard limb after the input is
+  // overwritten by the output of the previous call which only changes the
+  // values not the timing
+  bench_kernel(res, "_divmult", [](int j, size_t i){ _divmult(OUT(j, i), IN(j, i)); });
+
+#ifdef ASMSKIP
+  // one state of the conventional RANLUX generators per call, 24 bit words
+  // in 32 bit slots and 48 bit words in 64 bit slots
+  const uint64_t w24 = 0x00ffffff00ffffffUL, w48 = (1UL<<48) - 1;
+  bench_kernel(res, "_skipstates", [](int j, size_t){
+      C[j][0] = _skipstates((uint32_t*)S[j], C[j][0], 1);
+    }, w24);
+  bench_kernel(res, "_skipstates2", [](int j, size_t){ _skipstates2((uint32_t*)S[j], C[j], 1); }, w24);
+  bench_kernel(res, "_skipstates4", [](int j, size_t){ _skipstates4((uint32_t*)S[j], C[j], 1); }, w24);
+  bench_kernel(res, "_skipstates48", [](int j, size_t){
+      C[j][0] = _skipstates48(S[j][0], C[j][0], 1);
+    }, w48);
+#endif
+
+  if(!bmi2) fprintf(stderr, "No BMI2 (mulx) support, the mulx kernels are skipped.\n");
+  if(!adx) fprintf(stderr, "No ADX (adcx/adox) support, the mulxadox kernels are skipped.\n");
+}
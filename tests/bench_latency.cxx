@@ -0,0 +1,152 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Per call latency of the scalar draws. The average cost per number     *
+ * hides that the generators refill their buffers every 24th (or         *
+ * 24*lanes-th) call, here the time stamp counter is read after every    *
+ * draw, the deltas are collected in batches and then put in a histogram *
+ * to get the tail percentiles.                                          *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include "ranluxauto.h"
+
+// draws per batch between the histogram updates
+static const int B = 4096;
+static uint32_t deltas[B];
+
+// the time stamp counter: rdtscp waits until the draw has executed,
+// the lfence keeps the next draw from starting before the read
+static inline uint64_t tsc(){
+  uint32_t lo, hi, aux;
+  asm volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi), "=c"(aux) :: "memory");
+  return (uint64_t)hi<<32 | lo;
+}
+
+// one batch of draws, the deltas between the consecutive counter reads
+template<class F>
+static void batch(F draw){
+  uint64_t t = tsc();
+  for(int i=0;i<B;i++){
+    auto v = draw();
+    asm volatile("" :: "x"(v));
+    uint64_t t1 = tsc();
+    deltas[i] = t1 - t;
+    t = t1;
+  }
+}
+
+// the cost of the counter read and the loop without a draw
+static uint64_t overhead(){
+  static uint64_t o = ~(uint64_t)0;
+  if(o == ~(uint64_t)0){
+    histogram h;
+    for(int k=0;k<16;k++){
+      batch([](){ return 0.0f; });
+      for(int i=0;i<B;i++) h.add(deltas[i]);
+    }
+    o = h.percentile(0.5);
+  }
+  return o;
+}
+
+// draws for opts.repeat*opts.time seconds after a warm-up batch
+template<class F>
+static jsonobj latency(const std::string &name, const char *type, F draw){
+  using namespace std::chrono;
+  const uint64_t o = overhead();
+  histogram h;
+  batch(draw);
+  auto t0 = steady_clock::now();
+  do {
+    batch(draw);
+    for(int i=0;i<B;i++) h.add(deltas[i] > o ? deltas[i] - o : 0);
+  } while(duration<double>(steady_clock::now() - t0).count() < opts.repeat*opts.time);
+
+  const double q[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+  const char *qn[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+  jsonobj c, t;
+  for(int i=0;i<5;i++){
+    c.add(qn[i], h.percentile(q[i]));
+    t.add(qn[i], h.percentile(q[i])/tscghz());
+  }
+  c.add("max", h.max()).add("mean", h.mean());
+  t.add("max", h.max()/tscghz()).add("mean", h.mean()/tscghz());
+  jsonobj r;
+  r.add("name", name).add("type", type).add("api", "latency").add("draws", h.count())
+    .add("overhead_cycles", o).add("cycles", c).add("ns", t);
+  printf("%-36s %-7s p50 %6lu p99 %6lu p99.9 %6lu max %8lu mean %7.2f cycles\n",
+	 name.c_str(), type, (unsigned long)h.percentile(0.5), (unsigned long)h.percentile(0.99),
+	 (unsigned long)h.percentile(0.999), (unsigned long)h.max(), h.mean());
+  fflush(stdout);
+  return r;
+}
+
+template<class G>
+static void latency_ranluxI(std::vector<jsonobj> &res, const char *name){
+  if(!selected(std::string(name) + " float latency")) return;
+  G g(3124, 17);
+  res.push_back(latency(name, "float", [&g](){ return g(); }));
+}
+
+template<class G>
+static void latency_sequence(std::vector<jsonobj> &res, const char *name){
+  std::string n = std::string(name) + " sequence";
+  if(!selected(n + " float latency")) return;
+  G g(3124, 17);
+  g.initsequence(3124);
+  res.push_back(latency(n, "float", [&g](){ return g(); }));
+}
+
+void bench_latency(std::vector<jsonobj> &res){
+  printf("Counter read overhead %lu cycles is subtracted\n", (unsigned long)overhead());
+  for(int p : {2048, 24*17}){
+    std::string name = "ranluxpp p=" + std::to_string(p);
+    ranluxpp g(3124, p);
+    if(selected(name + " float latency"))
+      res.push_back(latency(name, "float", [&g](){ return g(0.0f); }));
+    if(selected(name + " double latency"))
+      res.push_back(latency(name, "double", [&g](){ return g(0.0); }));
+  }
+  latency_ranluxI<ranluxI_scalar>(res, "ranluxI_scalar p=408");
+  if(selected("ranluxI48_scalar p=408 double latency")){
+    ranluxI48_scalar g(3124, 17);
+    res.push_back(latency("ranluxI48_scalar p=408", "double", [&g](){ return g(); }));
+  }
+  latency_ranluxI<ranluxI_multi<4>>(res, "ranluxI_multi<4> p=408");
+  latency_ranluxI<ranluxI_SSE>(res, "ranluxI_SSE p=408");
+  latency_sequence<ranluxI_SSE>(res, "ranluxI_SSE p=408");
+#ifdef __AVX2__
+  latency_ranluxI<ranluxI_AVX>(res, "ranluxI_AVX p=408");
+  latency_sequence<ranluxI_AVX>(res, "ranluxI_AVX p=408");
+#endif
+#ifdef __AVX512F__
+  latency_ranluxI<ranluxI_AVX512>(res, "ranluxI_AVX512 p=408");
+  latency_sequence<ranluxI_AVX512>(res, "ranluxI_AVX512 p=408");
+#endif
+  if(selected("ranluxI_auto p=408 float latency")){
+    ranluxI_auto<float> g(3124, 17);
+    res.push_back(latency("ranluxI_auto p=408", "float", [&g](){ return g(); }));
+  }
+}
@@ -0,0 +1,151 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * The RANLUX generators next to the popular fast generators and the     *
+ * standard engines. Every generator is wrapped in an adapter with the   *
+ * same float/double conversion, so all run through identical scalar     *
+ * and bulk loops.                                                       *
+ *************************************************************************/
+
+#include "bench.h"
+#include "refgens.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include "ranluxstd.h"
+#include <stdlib.h>
+#include <random>
+
+// integer engine with W random bits per number: a float takes the top 24
+// bits of a number, a double the top 53 bits of one number or of two
+// numbers concatenated if a number has less than 48 bits
+template<class G, int W>
+class intadapter {
+  G _g;
+public:
+  static const int dbits = W >= 48 ? (W < 53 ? W : 53) : (2*W < 53 ? 2*W : 53);
+  intadapter(uint32_t seed) : _g(seed) {}
+  float flt(){ return (float)((uint64_t)_g()>>(W - 24))*0x1p-24f; }
+  double dbl(){
+    uint64_t x = _g();
+    if constexpr (W < 48){
+      x = x<<W | (uint64_t)_g();
+      return (double)(x>>(2*W - dbits))*ldexp(1.0, -dbits);
+    } else return (double)(x>>(W - dbits))*ldexp(1.0, -dbits);
+  }
+  void fill(float *a, int n){ for(int i=0;i<n;i++) a[i] = flt(); }
+  void fill(double *a, int n){ for(int i=0;i<n;i++) a[i] = dbl(); }
+};
+
+// ranluxpp with its own conversions and the array interface
+class ranluxppadapter {
+  ranluxpp _g;
+public:
+  static const int dbits = 52;
+  ranluxppadapter(uint32_t seed) : _g(seed, 2048) {}
+  float flt(){ return _g(0.0f); }
+  double dbl(){ return _g(0.0); }
+  void fill(float *a, int n){ _g.getarray(n, a); }
+  void fill(double *a, int n){ _g.getarray(n, a); }
+};
+
+// the conventional RANLUX delivering floats only
+template<class G>
+class ranluxIadapter {
+  G _g;
+public:
+  static const int dbits = 0;
+  ranluxIadapter(uint32_t seed) : _g(seed, 17) {}
+  float flt(){ return _g(); }
+  double dbl(){ return 0; }
+  void fill(float *a, int n){ for(int i=0;i<n;i++) a[i] = _g(); }
+  void fill(double *, int){}
+};
+
+// identical scalar and bulk loops for every generator
+template<class A>
+static void compare(std::vector<jsonobj> &res, const char *name, const char *quality){
+  const int M = 1024;
+  static float af[M];
+  static double ad[M];
+  A g(3124);
+  auto tag = [quality](jsonobj o){ return o.add("quality", quality); };
+  if(selected(std::string(name) + " float scalar"))
+    res.push_back(tag(measure(name, "float", "scalar", 24, [&g](size_t n){
+	    float s = 0;
+	    for(size_t i=0;i<n;i++) s += g.flt();
+	    return (double)s;
+	  })));
+  if(selected(std::string(name) + " float bulk"))
+    res.push_back(tag(measure(name, "float", "bulk", 24, [&g](size_t n){
+	    double s = 0;
+	    for(size_t i=0;i<n;i+=M){ g.fill(af, M); s += af[0]; }
+	    return s;
+	  })));
+  if(!A::dbits) return;
+  if(selected(std::string(name) + " double scalar"))
+    res.push_back(tag(measure(name, "double", "scalar", A::dbits, [&g](size_t n){
+	    double s = 0;
+	    for(size_t i=0;i<n;i++) s += g.dbl();
+	    return s;
+	  })));
+  if(selected(std::string(name) + " double bulk"))
+    res.push_back(tag(measure(name, "double", "bulk", A::dbits, [&g](size_t n){
+	    double s = 0;
+	    for(size_t i=0;i<n;i+=M){ g.fill(ad, M); s += ad[0]; }
+	    return s;
+	  })));
+}
+
+// known answers of the reference implementations
+static bool verify(){
+  bool ok = true;
+  // Random123 known answer test for the zero counter and key
+  uint32_t c[4] = {0, 0, 0, 0}, k[2] = {0, 0}, o[4];
+  philox4x32::block(o, c, k);
+  ok &= o[0] == 0x6627e8d5 && o[1] == 0xe169c58d && o[2] == 0xbc57ac4c && o[3] == 0x9b00dbd8;
+  // the 10000th number of the default seeded MT19937
+  mt19937ref mt;
+  std::mt19937 stdmt;
+  for(int i=0;i<9999;i++) mt(), stdmt();
+  ok &= mt() == 4123659995u && stdmt() == 4123659995u;
+  return ok;
+}
+
+void bench_reference(std::vector<jsonobj> &res){
+  if(!verify()){
+    fprintf(stderr, "The reference generators fail their known answer tests.\n");
+    exit(1);
+  }
+  compare<ranluxppadapter>(res, "ranluxpp p=2048", "RANLUX p=2048, beyond luxury level 4");
+  compare<ranluxIadapter<ranluxI_scalar>>(res, "ranluxI_scalar p=408", "RANLUX p=408, above luxury level 4");
+#ifdef __AVX2__
+  compare<ranluxIadapter<ranluxI_AVX>>(res, "ranluxI_AVX p=408", "RANLUX p=408, above luxury level 4, 8 streams");
+#endif
+  compare<intadapter<ranlux24pp, 24>>(res, "ranlux24pp", "std::ranlux24 sequence via LCG");
+  compare<intadapter<std::ranlux24, 24>>(res, "std::ranlux24", "RANLUX p=223, luxury level 3");
+  compare<intadapter<std::ranlux48, 48>>(res, "std::ranlux48", "RANLUX p=389");
+  compare<intadapter<philox4x32, 32>>(res, "Philox4x32-10", "passes BigCrush, counter based");
+  compare<intadapter<xoshiro256ss, 64>>(res, "xoshiro256**", "passes BigCrush, linear F2 engine");
+  compare<intadapter<pcg64, 64>>(res, "PCG64", "passes BigCrush");
+  compare<intadapter<mt19937ref, 32>>(res, "MT19937", "fails the linear complexity tests of BigCrush");
+  compare<intadapter<std::mt19937, 32>>(res, "std::mt19937", "fails the linear complexity tests of BigCrush");
+}
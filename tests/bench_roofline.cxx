@@ -0,0 +1,203 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Roofline of the bulk fills: the rate ranluxpp::getarray writes an     *
+ * array at is set against the store bandwidth of the same array size    *
+ * -- fitting in L1, L2, the last level cache or only in DRAM -- and the *
+ * same number of threads. The memory roof is the faster of the plain    *
+ * and the non-temporal store baselines, the compute roof is the fill    *
+ * rate with the array in L1. A fill close to the memory roof is store   *
+ * bandwidth bound, otherwise it is bound by the modular multiplication. *
+ * The non-temporal fills generate 1024 numbers into an L1 resident      *
+ * buffer and stream them to the array.                                  *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <immintrin.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+
+// numbers staged in L1 by the non-temporal fills
+static const int NSTAGE = 1024;
+
+// copy the L1 resident block to the array bypassing the caches
+static void streamcopy(void *dst, const void *src, size_t bytes){
+  __m256i *d = (__m256i*)dst;
+  const __m256i *s = (const __m256i*)src;
+  for(size_t i=0;i<bytes/32;i++) _mm256_stream_si256(d + i, _mm256_load_si256(s + i));
+}
+
+// per thread state: the array, the source of memcpy and the generator
+struct rooflinethread {
+  char *dst, *src;
+  alignas(32) char stage[NSTAGE*sizeof(double)];
+  std::unique_ptr<ranluxpp> g;
+};
+
+// one pass over the array of bytes
+typedef void (*passfn)(rooflinethread &, size_t bytes);
+
+static void pass_memcpy(rooflinethread &t, size_t bytes){ memcpy(t.dst, t.src, bytes); }
+
+static void pass_store(rooflinethread &t, size_t bytes){ memset(t.dst, 0x5a, bytes); }
+
+static void pass_ntstore(rooflinethread &t, size_t bytes){
+  __m256i v = _mm256_set1_epi8(0x5a);
+  __m256i *d = (__m256i*)t.dst;
+  for(size_t i=0;i<bytes/32;i++) _mm256_stream_si256(d + i, v);
+  _mm_sfence();
+}
+
+template<typename T>
+static void pass_fill(rooflinethread &t, size_t bytes){
+  t.g->getarray(bytes/sizeof(T), (T*)t.dst);
+}
+
+template<typename T>
+static void pass_fillnt(rooflinethread &t, size_t bytes){
+  const size_t chunk = NSTAGE*sizeof(T);
+  for(size_t o=0;o<bytes;o+=chunk){
+    t.g->getarray(NSTAGE, (T*)t.stage);
+    streamcopy(t.dst + o, t.stage, chunk);
+  }
+  _mm_sfence();
+}
+
+// the aggregate GB/s of the threads doing passes for opts.time
+static double runpasses(std::vector<rooflinethread> &th, const std::vector<int> &cpus,
+			size_t bytes, passfn pass){
+  size_t nt = th.size();
+  std::atomic<int> ready(0);
+  std::atomic<bool> go(false), stop(false);
+  std::vector<double> rate(nt);
+  std::vector<std::thread> w;
+  for(size_t k=0;k<nt;k++)
+    w.emplace_back([&, k](){
+	if(!cpus.empty()) pincpu(cpus[k % cpus.size()]);
+	pass(th[k], bytes); // warm up
+	ready++;
+	while(!go);
+	auto t0 = std::chrono::steady_clock::now();
+	size_t c = 0;
+	while(!stop){
+	  pass(th[k], bytes);
+	  c++;
+	}
+	double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	rate[k] = c*bytes/dt*1e-9;
+      });
+  while(ready < (int)nt) std::this_thread::yield();
+  go = true;
+  std::this_thread::sleep_for(std::chrono::duration<double>(opts.time));
+  stop = true;
+  for(auto &t : w) t.join();
+  double r = 0;
+  for(double x : rate) r += x;
+  return r;
+}
+
+static size_t cachesize(int name, size_t def){
+  long s = sysconf(name);
+  return s > 0 ? s : def;
+}
+
+void bench_roofline(std::vector<jsonobj> &res){
+  const char *policy = opts.pinning;
+  std::vector<int> order = cpuorder(policy), cpus;
+  if(strcmp(policy, "none")) cpus = order;
+  std::vector<int> nthreads = threadcounts(order.size());
+
+  // the array sizes: per thread for the private L1 and L2, the last level
+  // cache and DRAM are shared by the threads
+  size_t l1 = cachesize(_SC_LEVEL1_DCACHE_SIZE, 32<<10), l2 = cachesize(_SC_LEVEL2_CACHE_SIZE, 1<<20);
+  size_t llc = cachesize(_SC_LEVEL3_CACHE_SIZE, 0);
+  if(!llc) llc = 4*l2;
+  size_t dram = 4*llc < ((size_t)256<<20) ? (size_t)256<<20 : 4*llc;
+  if(dram > ((size_t)1<<30)) dram = (size_t)1<<30;
+  struct level { const char *name; size_t bytes; bool shared; };
+  const level levels[] = {{"L1", l1/2, false}, {"L2", l2/2, false}, {"LLC", llc/2, true},
+			  {"DRAM", dram, true}};
+
+  struct op { const char *name; passfn pass; bool fill; };
+  const op ops[] = {{"memcpy", pass_memcpy, false}, {"store", pass_store, false},
+		    {"ntstore", pass_ntstore, false},
+		    {"fill float", pass_fill<float>, true}, {"fill double", pass_fill<double>, true},
+		    {"fill float nt", pass_fillnt<float>, true},
+		    {"fill double nt", pass_fillnt<double>, true}};
+
+  printf("L1 %zu kB, L2 %zu kB, LLC %zu kB, DRAM array %zu MB\n", l1>>10, l2>>10, llc>>10, dram>>20);
+  for(int nt : nthreads){
+    std::map<std::string, double> l1fill; // the compute roof of every fill
+    for(const level &lv : levels){
+      size_t bytes = lv.shared ? lv.bytes/nt : lv.bytes;
+      bytes = bytes/(NSTAGE*sizeof(double))*(NSTAGE*sizeof(double));
+      if(!bytes) continue;
+      std::vector<rooflinethread> th(nt);
+      bool ok = true;
+      for(int k=0;k<nt;k++){
+	th[k].dst = (char*)aligned_alloc(64, bytes);
+	th[k].src = (char*)aligned_alloc(64, bytes);
+	if(!th[k].dst || !th[k].src){ ok = false; continue; }
+	memset(th[k].dst, 0, bytes);
+	memset(th[k].src, 1, bytes);
+	th[k].g.reset(new ranluxpp(3124 + k, 2048));
+      }
+      double memroof = 0;
+      for(const op &o : ops){
+	std::string name = std::string("roofline ") + lv.name + " " + o.name + " t=" + std::to_string(nt);
+	if(!ok || !selected(name)) continue;
+	std::vector<double> r;
+	for(int i=0;i<opts.repeat;i++) r.push_back(runpasses(th, cpus, bytes, o.pass));
+	benchstats s(r);
+	jsonobj j;
+	j.add("name", "roofline").add("level", lv.name).add("op", o.name).add("threads", nt)
+	  .add("bytes_per_thread", (uint64_t)bytes).add("gb_per_s", s);
+	printf("%-5s %7zu kB %3d threads %-15s %8.2f +- %-6.2f GB/s", lv.name, bytes>>10, nt, o.name,
+	       s.mean, s.sd);
+	if(!o.fill){
+	  if(strcmp(o.name, "memcpy") && s.mean > memroof) memroof = s.mean;
+	} else {
+	  if(!strcmp(lv.name, "L1")) l1fill[o.name] = s.mean;
+	  double compute = l1fill.count(o.name) ? l1fill[o.name] : s.mean;
+	  double roof = compute < memroof ? compute : memroof;
+	  const char *bound = memroof > 0 && memroof <= compute ? "memory" : "compute";
+	  j.add("memory_roof_gb_per_s", memroof).add("compute_roof_gb_per_s", compute)
+	    .add("roofline_gb_per_s", roof).add("fraction", roof > 0 ? s.mean/roof : NAN)
+	    .add("bound", bound);
+	  printf("  roof %.2f GB/s (%s bound), %.0f%%", roof, bound, roof > 0 ? 100*s.mean/roof : 0.0);
+	}
+	printf("\n");
+	fflush(stdout);
+	res.push_back(j);
+      }
+      for(auto &t : th){
+	free(t.dst);
+	free(t.src);
+      }
+    }
+  }
+}
@@ -0,0 +1,246 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Multi-threaded scaling: N threads run the same engine, each with its  *
+ * own generator, for a fixed time. The threads are pinned to the cpus   *
+ * in the order given by the pinning policy, so the SMT siblings sharing *
+ * the multiplier port or the vector units, the physical cores of a      *
+ * socket or the sockets are filled first.                               *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+// the position of a cpu in the machine
+struct cpuplace {
+  int cpu, package, core, smt; // smt -- index among the core siblings
+};
+
+static int readint(const std::string &path){
+  FILE *f = fopen(path.c_str(), "r");
+  int v = -1;
+  if(f){
+    if(fscanf(f, "%d", &v) != 1) v = -1;
+    fclose(f);
+  }
+  return v;
+}
+
+// the online cpus with their packages and cores from sysfs
+static std::vector<cpuplace> topology(){
+  std::vector<cpuplace> t;
+  int n = std::thread::hardware_concurrency();
+  for(int c=0;c<n;c++){
+    std::string d = "/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/";
+    cpuplace p = {c, readint(d + "physical_package_id"), readint(d + "core_id"), 0};
+    if(p.package < 0) p.package = 0;
+    if(p.core < 0) p.core = c;
+    for(auto &q : t) if(q.package == p.package && q.core == p.core) p.smt++;
+    t.push_back(p);
+  }
+  return t;
+}
+
+// the cpus in the order the threads are pinned to them:
+// cores   -- one thread per physical core, socket by socket, then the siblings
+// smt     -- both siblings of a core before the next core
+// sockets -- one thread per physical core alternating the sockets, then the siblings
+// none    -- no pinning, the scheduler places the threads
+std::vector<int> cpuorder(const char *policy){
+  std::vector<cpuplace> t = topology();
+  auto key = [policy](const cpuplace &p){
+    if(!strcmp(policy, "smt")) return std::make_tuple(p.package, p.core, p.smt, 0);
+    if(!strcmp(policy, "sockets")) return std::make_tuple(p.smt, 0, p.core, p.package);
+    return std::make_tuple(p.smt, p.package, p.core, 0);
+  };
+  std::stable_sort(t.begin(), t.end(), [&key](const cpuplace &a, const cpuplace &b){
+      return key(a) < key(b);
+    });
+  std::vector<int> o;
+  for(auto &p : t) o.push_back(p.cpu);
+  return o;
+}
+
+std::vector<int> threadcounts(int ncpu){
+  std::vector<int> nthreads;
+  if(opts.threads){
+    for(const char *p = opts.threads; *p;){
+      int n = atoi(p);
+      if(n > 0) nthreads.push_back(n);
+      p += strcspn(p, ",");
+      if(*p) p++;
+    }
+  } else {
+    for(int n = 1; n < ncpu; n *= 2) nthreads.push_back(n);
+    nthreads.push_back(ncpu);
+  }
+  return nthreads;
+}
+
+// a per thread generator producing n numbers and returning the checksum
+typedef std::function<double(size_t)> worker;
+
+struct scalingengine {
+  const char *name, *type;
+  double bits;
+  size_t chunk; // numbers between the checks of the stop flag
+  std::function<worker(int seed)> make;
+};
+
+template<class G>
+static worker ranluxIworker(int seed){
+  auto g = std::make_shared<G>(seed, 17);
+  return [g](size_t n){
+    float s = 0;
+    for(size_t i=0;i<n;i++) s += (*g)();
+    return (double)s;
+  };
+}
+
+static std::vector<scalingengine> engines(){
+  std::vector<scalingengine> e;
+  e.push_back({"ranluxpp p=2048", "state", 576, 64, [](int seed) -> worker {
+	auto g = std::make_shared<ranluxpp>(seed, 2048);
+	return [g](size_t n){
+	  for(size_t i=0;i<n;i++) g->nextstate();
+	  return (double)g->getstate()[0];
+	};
+      }});
+  e.push_back({"ranluxpp p=2048", "float", 24, 4096, [](int seed) -> worker {
+	auto g = std::make_shared<ranluxpp>(seed, 2048);
+	auto a = std::make_shared<std::vector<float>>(1024);
+	return [g, a](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i+=1024){ g->getarray(1024, a->data()); s += (*a)[0]; }
+	  return s;
+	};
+      }});
+  e.push_back({"ranluxI_scalar p=408", "float", 24, 4096, ranluxIworker<ranluxI_scalar>});
+  e.push_back({"ranluxI_SSE p=408", "float", 24, 4096, ranluxIworker<ranluxI_SSE>});
+#ifdef __AVX2__
+  e.push_back({"ranluxI_AVX p=408", "float", 24, 4096, ranluxIworker<ranluxI_AVX>});
+#endif
+#ifdef __AVX512F__
+  e.push_back({"ranluxI_AVX512 p=408", "float", 24, 4096, ranluxIworker<ranluxI_AVX512>});
+#endif
+  return e;
+}
+
+// the numbers per second of every thread in one timed run
+static std::vector<double> run(const scalingengine &e, std::vector<worker> &w,
+			       const std::vector<int> &cpus){
+  size_t nt = w.size();
+  std::atomic<int> ready(0);
+  std::atomic<bool> go(false), stop(false);
+  std::vector<double> rate(nt);
+  std::vector<std::thread> th;
+  for(size_t k=0;k<nt;k++)
+    th.emplace_back([&, k](){
+	if(!cpus.empty()) pincpu(cpus[k % cpus.size()]);
+	ready++;
+	while(!go);
+	auto t0 = std::chrono::steady_clock::now();
+	size_t c = 0;
+	double s = 0;
+	while(!stop){
+	  s += w[k](e.chunk);
+	  c += e.chunk;
+	}
+	double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	benchsink = s;
+	rate[k] = c/dt;
+      });
+  while(ready < (int)nt) std::this_thread::yield();
+  go = true;
+  std::this_thread::sleep_for(std::chrono::duration<double>(opts.time));
+  stop = true;
+  for(auto &t : th) t.join();
+  return rate;
+}
+
+void bench_scaling(std::vector<jsonobj> &res){
+  const char *policy = opts.pinning;
+  std::vector<int> order = cpuorder(policy), cpus;
+  if(strcmp(policy, "none")) cpus = order;
+  else {
+    // undo the pinning of the main thread, the workers inherit it
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int c : order) CPU_SET(c, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+
+  std::vector<int> nthreads = threadcounts(order.size());
+
+  printf("Pinning %s, cpu order", policy);
+  for(int c : order) printf(" %d", c);
+  printf("\n");
+
+  for(const scalingengine &e : engines()){
+    std::string name = std::string(e.name) + " " + e.type + " scaling";
+    if(!selected(name)) continue;
+    // the efficiency is relative to one thread, which is measured even if not asked for
+    auto measure = [&](int nt, std::vector<double> &perthread){
+      std::vector<worker> w;
+      for(int k=0;k<nt;k++) w.push_back(e.make(3124 + k));
+      std::vector<double> total;
+      perthread.assign(nt, 0);
+      for(int r=0;r<opts.repeat;r++){
+	std::vector<double> rate = run(e, w, cpus);
+	double t = 0;
+	for(int k=0;k<nt;k++){ t += rate[k]; perthread[k] += rate[k]/opts.repeat; }
+	total.push_back(t);
+      }
+      return benchstats(total);
+    };
+    std::vector<double> perthread;
+    double single = 0;
+    if(!nthreads.empty() && nthreads[0] != 1)
+      single = measure(1, perthread).mean;
+    for(int nt : nthreads){
+      benchstats s = measure(nt, perthread);
+      if(nt == 1) single = s.mean;
+      std::vector<int> used;
+      for(int k=0;k<nt && !cpus.empty();k++) used.push_back(cpus[k % cpus.size()]);
+      std::vector<double> usedd(used.begin(), used.end());
+      jsonobj o;
+      o.add("name", e.name).add("type", e.type).add("api", "scaling").add("bits", e.bits)
+	.add("threads", nt).add("pinning", policy).add("cpus", usedd)
+	.add("numbers_per_s", s).add("per_thread_numbers_per_s", perthread)
+	.add("gb_per_s", s.mean*e.bits/8e9).add("efficiency", s.mean/(nt*single));
+      if(nt > (int)order.size()) o.add("oversubscribed", 1);
+      res.push_back(o);
+      printf("%-24s %-6s %3d threads %10.4g +- %-9.3g numbers/s %8.3f GB/s efficiency %.2f%s\n",
+	     e.name, e.type, nt, s.mean, s.sd, s.mean*e.bits/8e9, s.mean/(nt*single),
+	     nt > (int)order.size() ? " (oversubscribed)" : "");
+      fflush(stdout);
+    }
+  }
+}
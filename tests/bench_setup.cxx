@@ -0,0 +1,120 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * The cost of setting the generators up: construction, reseeding,       *
+ * changing the skipping and jumping ahead, per operation, over the seed *
+ * magnitude and the jump distance. The seeding of ranluxpp jumps by     *
+ * 2^96*seed numbers, i.e. the cost grows with log2(seed).               *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+
+// one operation per call of op(i), the checksum is taken from the state
+template<class F, class S>
+static void setup(std::vector<jsonobj> &res, const std::string &name, const char *api,
+		  F op, S sum){
+  if(!selected(name + " op " + api)) return;
+  res.push_back(measure(name, "op", api, 0, [&op, &sum](size_t n){
+	for(size_t i=0;i<n;i++) op(i);
+	return sum();
+      }));
+}
+
+static std::string pow2(int k){ return "2^" + std::to_string(k); }
+
+void bench_setup(std::vector<jsonobj> &res){
+  const int seedbits[] = {0, 8, 16, 32, 48, 63};
+
+  // ranluxpp: construction and reseeding over the seed magnitude
+  for(int b : seedbits){
+    uint64_t s = (uint64_t)1<<b;
+    std::string name = "ranluxpp seed=" + pow2(b);
+    uint64_t x = 0;
+    setup(res, name, "construct", [s, &x](size_t i){
+	ranluxpp g(s + (i&1), 2048);
+	x += g.getstate()[0];
+      }, [&x](){ return (double)x; });
+    ranluxpp g(1, 2048);
+    setup(res, name, "init", [s, &g](size_t i){ g.init(s + (i&1)); },
+	  [&g](){ return (double)g.getstate()[0]; });
+  }
+
+  // ranluxpp: the multiplier for the skipping p
+  for(uint64_t p : {24UL, 408UL, 2048UL, 1UL<<20, 1UL<<40}){
+    ranluxpp g(1, 2048);
+    setup(res, "ranluxpp p=" + std::to_string(p), "setskip", [p, &g](size_t i){ g.setskip(p + (i&1)); },
+	  [&g](){ return (double)g.getmultiplier()[0]; });
+  }
+
+  // ranluxpp: jump by n numbers
+  for(int b : {0, 5, 10, 20, 30, 40, 63}){
+    uint64_t n = (uint64_t)1<<b;
+    ranluxpp g(1, 2048);
+    setup(res, "ranluxpp n=" + pow2(b), "jump", [n, &g](size_t){ g.jump(n); },
+	  [&g](){ return (double)g.getstate()[0]; });
+  }
+
+  // the conventional RANLUX: construction, reseeding and jumping by n
+  // states, a construction is checksummed by its state without drawing
+  {
+    uint64_t x = 0;
+    setup(res, "ranluxI_scalar", "construct", [&x](size_t i){
+	ranluxI_scalar g(i, 17);
+	uint32_t s[24], c;
+	g.getstate(s, c);
+	x += s[i%24] + c;
+      }, [&x](){ return (double)x; });
+    ranluxI_scalar g(1, 17);
+    setup(res, "ranluxI_scalar", "init", [&g](size_t i){ g.init(i); },
+	  [&g](){ return (double)g(); });
+    for(int b : {0, 4, 8, 12, 16, 20, 30, 40}){
+      uint64_t n = (uint64_t)1<<b;
+      setup(res, "ranluxI_scalar n=" + pow2(b), "jump", [n, &g](size_t){ g.jump(n); },
+	    [&g](){ return (double)g(); });
+    }
+  }
+#ifdef __AVX2__
+  {
+    uint64_t x = 0;
+    std::vector<uint32_t> buf((ranluxI_AVX(1, 17).save(NULL) + 3)/4);
+    setup(res, "ranluxI_AVX", "construct", [&x, &buf](size_t i){
+	ranluxI_AVX g(i, 17);
+	g.save(buf.data());
+	x += buf[i%buf.size()];
+      }, [&x](){ return (double)x; });
+    ranluxI_AVX g(1, 17), q(1, 17);
+    setup(res, "ranluxI_AVX", "init", [&g](size_t i){ g.init(i); },
+	  [&g](){ return (double)g(); });
+    setup(res, "ranluxI_AVX sequence", "init", [&q](size_t i){ q.initsequence(i); },
+	  [&q](){ return (double)q(); });
+    for(int b : {0, 8, 16, 30}){
+      uint64_t n = (uint64_t)1<<b;
+      setup(res, "ranluxI_AVX n=" + pow2(b), "jump", [n, &g](size_t){ g.jump(n); },
+	    [&g](){ return (double)g(); });
+      setup(res, "ranluxI_AVX sequence n=" + pow2(b), "jump", [n, &q](size_t){ q.jump(n); },
+	    [&q](){ return (double)q(); });
+    }
+  }
+#endif
+}
@@ -0,0 +1,209 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Parameter sweeps: the luxury p for every engine and output type, and  *
+ * the getarray block size from 1 to 10^8 numbers. The skipping of the   *
+ * conventional RANLUX costs ~p, the LCG jump ~log2(p), so there is a    *
+ * crossover luxury above which ranluxpp is faster, it is located on the *
+ * current CPU by linear interpolation between the sweep points.         *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include <stdlib.h>
+#include <map>
+#include <memory>
+
+// one point of a sweep
+struct sweeppoint {
+  std::string sweep, engine, type;
+  int p;
+  long block;
+  double cycles, ns, gbs;
+};
+
+// run the measurement and note the point
+template<class F>
+static void point(std::vector<jsonobj> &res, std::vector<sweeppoint> &pts, const char *sweep,
+		  const std::string &engine, const char *type, const char *api, double bits,
+		  int p, long block, F f){
+  jsonobj o = measure(engine + " p=" + std::to_string(p)
+		      + (block ? " block=" + std::to_string(block) : std::string("")),
+		      type, api, bits, f, block ? block : 1);
+  const benchresult &r = benchresults.back();
+  double ghz = tscghz();
+  pts.push_back({sweep, engine, type, p, block, r.mean, r.mean/ghz, bits*ghz/(8*r.mean)});
+  o.add("sweep", sweep).add("engine", engine).add("p", p).add("block", (uint64_t)block);
+  res.push_back(o);
+}
+
+template<class G>
+static void sweep_ranluxI(std::vector<jsonobj> &res, std::vector<sweeppoint> &pts,
+			  const char *engine, int p){
+  if(!selected(std::string(engine) + " p=" + std::to_string(p) + " float")) return;
+  G g(3124, p/24);
+  point(res, pts, "luxury", engine, "float", "scalar", 24, p, 0, [&g](size_t n){
+      float s = 0;
+      for(size_t i=0;i<n;i++) s += g();
+      return (double)s;
+    });
+}
+
+// the smallest luxury at which the engine a is faster than b, interpolated
+// between the sweep points, 0 if a is faster everywhere, -1 if nowhere
+static double crossover(const std::vector<sweeppoint> &pts, const std::string &a,
+			const std::string &b, const std::string &type){
+  std::map<int, double> ta, tb;
+  for(auto &q : pts){
+    if(q.sweep != "luxury" || q.type != type) continue;
+    if(q.engine == a) ta[q.p] = q.cycles;
+    if(q.engine == b) tb[q.p] = q.cycles;
+  }
+  double p0 = -1, r0 = 0;
+  for(auto &i : ta){
+    auto j = tb.find(i.first);
+    if(j == tb.end()) continue;
+    double r = i.second/j->second - 1; // negative where a is faster
+    if(r <= 0) return p0 < 0 ? 0 : p0 + (i.first - p0)*r0/(r0 - r);
+    p0 = i.first;
+    r0 = r;
+  }
+  return -1;
+}
+
+static std::vector<long> parselist(const char *s){
+  std::vector<long> v;
+  for(const char *p = s; *p;){
+    long x = atof(p);
+    if(x > 0) v.push_back(x);
+    p += strcspn(p, ",");
+    if(*p) p++;
+  }
+  return v;
+}
+
+void bench_sweep(std::vector<jsonobj> &res){
+  std::vector<sweeppoint> pts;
+  std::vector<long> lux = parselist(opts.sweepp ? opts.sweepp
+				    : "24,48,96,192,288,408,576,768,1152,1536,2304,3072");
+  std::vector<long> blocks = parselist(opts.sweepblock ? opts.sweepblock
+				       : "1,10,100,1000,1e4,1e5,1e6,1e7,1e8");
+
+  // the luxury sweep, the conventional RANLUX skips whole states, p is
+  // rounded to a multiple of 24
+  for(long &p : lux) p = p < 24 ? 24 : p/24*24;
+  for(long p : lux){
+    if(selected("ranluxpp p=" + std::to_string(p) + " float")){
+      ranluxpp g(3124, p);
+      point(res, pts, "luxury", "ranluxpp", "float", "scalar", 24, p, 0, [&g](size_t n){
+	  float s = 0;
+	  for(size_t i=0;i<n;i++) s += g(0.0f);
+	  return (double)s;
+	});
+    }
+    if(selected("ranluxpp p=" + std::to_string(p) + " double")){
+      ranluxpp g(3124, p);
+      point(res, pts, "luxury", "ranluxpp", "double", "scalar", 52, p, 0, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i++) s += g(0.0);
+	  return s;
+	});
+    }
+    sweep_ranluxI<ranluxI_scalar>(res, pts, "ranluxI_scalar", p);
+    sweep_ranluxI<ranluxI_SSE>(res, pts, "ranluxI_SSE", p);
+#ifdef __AVX2__
+    sweep_ranluxI<ranluxI_AVX>(res, pts, "ranluxI_AVX", p);
+#endif
+#ifdef __AVX512F__
+    sweep_ranluxI<ranluxI_AVX512>(res, pts, "ranluxI_AVX512", p);
+#endif
+    if(selected("ranluxI48_scalar p=" + std::to_string(p) + " double")){
+      ranluxI48_scalar g(3124, p/24);
+      point(res, pts, "luxury", "ranluxI48_scalar", "double", "scalar", 48, p, 0, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i++) s += g();
+	  return s;
+	});
+    }
+  }
+
+  // the getarray block size sweep of ranluxpp at the default luxury
+  for(long m : blocks){
+    std::string b = " block=" + std::to_string(m);
+    for(int dbl=0;dbl<2;dbl++){
+      const char *type = dbl ? "double" : "float";
+      if(!selected("ranluxpp p=2048" + b + " " + type)) continue;
+      ranluxpp g(3124, 2048);
+      size_t sz = dbl ? sizeof(double) : sizeof(float);
+      std::unique_ptr<char[]> buf(new (std::nothrow) char[m*sz]);
+      if(!buf){
+	fprintf(stderr, "No memory for the block of %ld numbers, skipped.\n", m);
+	continue;
+      }
+      char *a = buf.get();
+      point(res, pts, "block", "ranluxpp", type, "array", dbl ? 52 : 24, 2048, m,
+	    [&g, a, m, dbl](size_t n){
+	      double s = 0;
+	      for(size_t i=0;i<n;i+=m){
+		if(dbl){ g.getarray(m, (double*)a); s += *(double*)a; }
+		else { g.getarray(m, (float*)a); s += *(float*)a; }
+	      }
+	      return s;
+	    });
+    }
+  }
+
+  // where the LCG multiplication beats the skipping of the conventional RANLUX
+  printf("\nCrossover luxury p above which ranluxpp is faster:\n");
+  jsonobj cr;
+  const char *swb[][2] = {{"ranluxI_scalar", "float"}, {"ranluxI_SSE", "float"},
+			  {"ranluxI_AVX", "float"}, {"ranluxI_AVX512", "float"},
+			  {"ranluxI48_scalar", "double"}};
+  for(auto &e : swb){
+    double p = crossover(pts, "ranluxpp", e[0], e[1]);
+    bool any = false;
+    for(auto &q : pts) any |= q.engine == e[0];
+    if(!any) continue;
+    std::string k = std::string("ranluxpp vs ") + e[0] + " " + e[1];
+    if(p < 0) printf("  %-40s above p=%ld\n", k.c_str(), lux.empty() ? 0 : lux.back());
+    else if(p == 0) printf("  %-40s below p=%ld\n", k.c_str(), lux.empty() ? 0 : lux.front());
+    else printf("  %-40s p=%.0f\n", k.c_str(), p);
+    cr.add(k.c_str(), p < 0 ? NAN : p);
+  }
+  jsonobj o;
+  o.add("name", "crossover").add("api", "summary").add("crossover_p", cr);
+  res.push_back(o);
+
+  if(opts.csv){
+    FILE *f = strcmp(opts.csv, "-") ? fopen(opts.csv, "w") : stdout;
+    if(!f){
+      perror(opts.csv);
+      return;
+    }
+    fprintf(f, "sweep,engine,type,p,block,cycles_per_number,ns_per_number,gb_per_s\n");
+    for(auto &q : pts)
+      fprintf(f, "%s,%s,%s,%d,%ld,%.4g,%.4g,%.4g\n", q.sweep.c_str(), q.engine.c_str(),
+	      q.type.c_str(), q.p, q.block, q.cycles, q.ns, q.gbs);
+    if(f != stdout) fclose(f);
+  }
+}
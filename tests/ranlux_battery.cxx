@@ -0,0 +1,628 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Parallel statistical test battery. Every engine and output format is  *
+ * a source of w-bit integers: the floats as multiples of 2^-24, the     *
+ * doubles as multiples of 2^-52 (ranluxpp) or 2^-48 (ranluxI48) and the *
+ * raw ranluxpp LCG state as 64-bit words. Every thread runs its own     *
+ * generator jumped to a disjoint substream and accumulates the counts   *
+ * of the tests, which are summed over the threads into one p-value per  *
+ * test:                                                                 *
+ *   frequency          -- the ones in the bit stream (NIST monobit)     *
+ *   gap                -- the gaps between the numbers in [0, 1/8)      *
+ *                         (Knuth), the top 24 bits of every number      *
+ *   birthday spacings  -- repeated spacings of 4096 birthdays in 2^36   *
+ *                         days (Marsaglia), the top 18 bits of two      *
+ *                         numbers per birthday, a fixed number of years *
+ *   matrix rank        -- ranks of 32x32 binary matrices over GF(2),    *
+ *                         every 16th 1024-bit block of the bit stream   *
+ *   linear complexity  -- Berlekamp-Massey on 500-bit blocks (NIST),    *
+ *                         every 256th 512-bit block of the bit stream   *
+ * The bit stream is the concatenation of the w bits of the numbers.     *
+ *************************************************************************/
+
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <immintrin.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// numbers per refill of a source, a multiple of the 9 words of the
+// ranluxpp state and of the 8x24 numbers of ranluxI_AVX
+static const int NBUF = 4608;
+
+// the generator parameters and the run size
+static struct {
+  double size = 1;         // GB per source
+  int threads = 0;         // 0 -- one per cpu
+  int seed = 3124;
+  int p = 2048;            // ranluxpp luxury in numbers
+  int lux = 17;            // ranluxI_* luxury in states
+  const char *filter = NULL;
+} opts;
+
+/*************************************************************************
+ * sources                                                               *
+ *************************************************************************/
+
+// a substream of w-bit numbers
+class source {
+public:
+  virtual ~source(){}
+  virtual void fill(uint64_t *v) = 0; // NBUF numbers
+};
+
+// ranluxpp floats or doubles through getarray
+template<typename T>
+class source_pp : public source {
+  ranluxpp _g;
+  T _a[NBUF];
+public:
+  source_pp(int seed, int k):_g(seed, opts.p){ if(k) _g.jump((uint64_t)k<<58); }
+  void fill(uint64_t *v){
+    _g.getarray(NBUF, _a);
+    const T s = sizeof(T) == 4 ? 0x1p24 : 0x1p52;
+    for(int i=0;i<NBUF;i++) v[i] = (int64_t)(_a[i]*s);
+  }
+};
+
+// the raw ranluxpp LCG states
+class source_ppstate : public source {
+  ranluxpp _g;
+public:
+  source_ppstate(int seed, int k):_g(seed, opts.p){ if(k) _g.jump((uint64_t)k<<58); }
+  void fill(uint64_t *v){
+    for(int i=0;i<NBUF;i+=9){
+      _g.nextstate();
+      memcpy(v + i, _g.getstate(), 9*sizeof(uint64_t));
+    }
+  }
+};
+
+// the scalar draws of the conventional RANLUX engines, the numbers are
+// multiples of 2^-w
+template<class G, int w>
+class source_swb : public source {
+  G _g;
+public:
+  source_swb(int seed, int k):_g(seed, opts.lux){ if(k) _g.jump((uint64_t)k<<52); }
+  void fill(uint64_t *v){
+    for(int i=0;i<NBUF;i++) v[i] = (int64_t)(_g()*(double)(1ull<<w));
+  }
+};
+
+template<class S>
+static source *makesource(int seed, int k){ return new S(seed, k); }
+
+struct sourcedef {
+  const char *name;
+  int bits;
+  source *(*make)(int seed, int k);
+};
+
+static const sourcedef sources[] = {
+  {"ranluxpp float", 24, makesource<source_pp<float>>},
+  {"ranluxpp double", 52, makesource<source_pp<double>>},
+  {"ranluxpp state", 64, makesource<source_ppstate>},
+  {"ranluxI_scalar float", 24, makesource<source_swb<ranluxI_scalar, 24>>},
+  {"ranluxI48_scalar double", 48, makesource<source_swb<ranluxI48_scalar, 48>>},
+#ifdef __AVX2__
+  {"ranluxI_AVX float", 24, makesource<source_swb<ranluxI_AVX, 24>>},
+#endif
+};
+
+/*************************************************************************
+ * tests                                                                 *
+ *************************************************************************/
+
+static const int GAPT = 64;                 // gaps of length >= GAPT are pooled
+static const int GAPBITS = 21;              // hit: the top 24 bits below 2^21
+static const int BDAYM = 4096;              // birthdays per year
+static const int BDAYBITS = 36;             // 2^36 days, m^2/n small enough for the Poisson limit
+static const uint64_t BDAYYEARS = 1<<12;    // years over all threads
+static const int RKSTRIDE = 16;             // test every 16th 1024-bit block
+static const int LCM = 500;                 // linear complexity block length
+static const int LCSTRIDE = 256;            // test every 256th 512-bit block
+
+// the counts of the tests, summed over the threads
+struct counts {
+  uint64_t nbits = 0, ones = 0;
+  uint64_t gaps[GAPT+1] = {};
+  uint64_t years = 0, dups = 0;
+  uint64_t ranks[3] = {};                   // rank 32, 31, <= 30
+  uint64_t lc[7] = {};                      // L - M/2 <= -3, -2, ..., >= 3
+
+  counts &operator+=(const counts &a){
+    nbits += a.nbits; ones += a.ones;
+    for(int i=0;i<=GAPT;i++) gaps[i] += a.gaps[i];
+    years += a.years; dups += a.dups;
+    for(int i=0;i<3;i++) ranks[i] += a.ranks[i];
+    for(int i=0;i<7;i++) lc[i] += a.lc[i];
+    return *this;
+  }
+};
+
+// the rank over GF(2) of the 32x32 matrix with the rows r, destroys r;
+// Gauss-Jordan elimination without branches on the matrix elements
+#ifdef __AVX2__
+static int rank32(uint32_t *r){
+  __m256i v[4], idx[4];
+  for(int j=0;j<4;j++){
+    v[j] = _mm256_loadu_si256((const __m256i*)r + j);
+    idx[j] = _mm256_setr_epi32(8*j, 8*j+1, 8*j+2, 8*j+3, 8*j+4, 8*j+5, 8*j+6, 8*j+7);
+  }
+  uint32_t used = 0;
+  int rank = 0;
+  for(int c=0;c<32;c++){
+    // the bit c of every row to the sign bit
+    __m128i sh = _mm_cvtsi32_si128(31 - c);
+    __m256i t[4];
+    uint32_t has = 0;
+    for(int j=0;j<4;j++){
+      t[j] = _mm256_sll_epi32(v[j], sh);
+      has |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(t[j]))<<8*j;
+    }
+    has &= ~used;
+    if(!has) continue;
+    int k = __builtin_ctz(has);
+    for(int j=0;j<4;j++) _mm256_storeu_si256((__m256i*)r + j, v[j]);
+    __m256i p = _mm256_set1_epi32(r[k]), K = _mm256_set1_epi32(k);
+    for(int j=0;j<4;j++){
+      __m256i m = _mm256_andnot_si256(_mm256_cmpeq_epi32(idx[j], K), _mm256_srai_epi32(t[j], 31));
+      v[j] = _mm256_xor_si256(v[j], _mm256_and_si256(p, m));
+    }
+    used |= 1u<<k;
+    rank++;
+  }
+  return rank;
+}
+#else
+static int rank32(uint32_t *r){
+  uint32_t used = 0;
+  int rank = 0;
+  for(int c=0;c<32;c++){
+    uint32_t has = 0; // the rows with the bit c
+    for(int i=0;i<32;i++) has |= ((r[i]>>c)&1)<<i;
+    has &= ~used;
+    if(!has) continue;
+    int k = __builtin_ctz(has);
+    uint32_t p = r[k];
+    for(int i=0;i<32;i++) r[i] ^= p & -((r[i]>>c)&1);
+    r[k] = p;
+    used |= 1u<<k;
+    rank++;
+  }
+  return rank;
+}
+#endif
+
+// sort the n 36-bit keys in a, b is the scratch space; returns the
+// sorted array, which is b
+static uint64_t *radixsort36(uint64_t *a, uint64_t *b, int n){
+  for(int sh=0;sh<36;sh+=12){
+    uint32_t cnt[4097] = {};
+    for(int i=0;i<n;i++) cnt[((a[i]>>sh)&4095) + 1]++;
+    for(int i=1;i<4096;i++) cnt[i] += cnt[i-1];
+    for(int i=0;i<n;i++) b[cnt[(a[i]>>sh)&4095]++] = a[i];
+    std::swap(a, b);
+  }
+  return a;
+}
+
+// the linear complexity of the n <= 512 bits s (bit i of the sequence is
+// bit i%64 of s[i/64]) by the Berlekamp-Massey algorithm on 512-bit words,
+// the updates are selected by masks instead of branches
+static int linearcomplexity(const uint64_t *s, int n){
+  // C the connection polynomial, D = B*x^(k-m) the correction to it
+  uint64_t C[8] = {1}, D[8] = {2}, R[8] = {0};
+  int L = 0;
+  for(int k=0;k<n;k++){
+    // R holds the sequence backwards, bit i = s_{k-i}
+    for(int j=7;j>0;j--) R[j] = R[j]<<1 | R[j-1]>>63;
+    R[0] = R[0]<<1 | ((s[k>>6]>>(k&63))&1);
+    uint64_t d = 0;
+    for(int j=0;j<8;j++) d ^= C[j] & R[j];
+    uint64_t md = -(uint64_t)(__builtin_popcountll(d)&1); // the discrepancy
+    uint64_t ml = md & -(uint64_t)(2*L <= k);             // and the length grows
+    for(int j=0;j<8;j++){
+      uint64_t c = C[j];
+      C[j] = c ^ (D[j] & md);
+      D[j] = (c & ml) | (D[j] & ~ml);
+    }
+    for(int j=7;j>0;j--) D[j] = D[j]<<1 | D[j-1]>>63;
+    D[0] <<= 1;
+    L = ml ? k + 1 - L : L;
+  }
+  return L;
+}
+
+// the tests of one thread on its stream of w-bit numbers
+class teststream {
+  int _w;
+  uint64_t _acc = 0;           // the bits not yet forming a 64-bit word
+  int _nacc = 0;
+  uint64_t _words[NBUF];       // the 64-bit words of the bit stream of a refill
+  uint32_t _rows[32];
+  int _rkpos = 0;              // words into the RKSTRIDE blocks
+  uint64_t _lcbuf[8];
+  int _lcpos = 0;              // words into the LCSTRIDE blocks
+  uint64_t _gap = 0;
+  bool _hit = false;           // the first hit is seen
+  uint64_t _days[BDAYM], _tmp[BDAYM];
+  int _ndays = 0;
+  bool _half = false;          // the first 18 bits of a day are in
+  uint64_t _years;             // years left to this thread
+
+  // frequency, matrix rank and linear complexity on n words
+  void bits(const uint64_t *x, int n){
+    uint64_t ones = 0;
+    for(int i=0;i<n;i++) ones += __builtin_popcountll(x[i]);
+    c.nbits += 64*(uint64_t)n;
+    c.ones += ones;
+    for(int i=0;i<n;i++){
+      if(_rkpos < 16){
+	_rows[2*_rkpos] = x[i];
+	_rows[2*_rkpos+1] = x[i]>>32;
+	if(_rkpos == 15){
+	  int r = rank32(_rows);
+	  c.ranks[r >= 31 ? 32 - r : 2]++;
+	}
+      }
+      if(++_rkpos == 16*RKSTRIDE) _rkpos = 0;
+    }
+    for(int i=0;i<n;i++){
+      if(_lcpos < 8){
+	_lcbuf[_lcpos] = x[i];
+	if(_lcpos == 7){
+	  int d = linearcomplexity(_lcbuf, LCM) - LCM/2;
+	  c.lc[std::min(std::max(d, -3), 3) + 3]++;
+	}
+      }
+      if(++_lcpos == 8*LCSTRIDE) _lcpos = 0;
+    }
+  }
+
+  // the gap test, a hit is a number below 2^(w-3); the hits of 64
+  // numbers are collected to a bit mask and visited one by one
+  void gaps(const uint64_t *v, int n){
+    const uint64_t lim = 1ull<<(_w - (24 - GAPBITS));
+    int64_t last = -1 - (int64_t)_gap; // the last hit
+    bool hit = _hit;
+    uint64_t cnt[GAPT+1] = {};
+    for(int b=0;b<n;b+=64){
+      int nb = std::min(64, n - b);
+      uint64_t m = 0;
+#ifdef __AVX2__
+      if(nb == 64){
+	// unsigned compare as signed one with the sign bits flipped
+	const __m256i sign = _mm256_set1_epi64x(1ll<<63), l = _mm256_set1_epi64x(lim ^ (1ull<<63));
+	for(int j=0;j<64;j+=4){
+	  __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(v + b + j)), sign);
+	  m |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(l, x)))<<j;
+	}
+      } else
+#endif
+      for(int j=0;j<nb;j++) m |= (uint64_t)(v[b+j] < lim)<<j;
+      for(;m;m&=m-1){
+	int64_t i = b + __builtin_ctzll(m);
+	uint64_t g = i - last - 1;
+	if(hit) cnt[g < GAPT ? g : GAPT]++;
+	hit = true;
+	last = i;
+      }
+    }
+    _hit = hit;
+    if(hit) _gap = n - 1 - last;
+    for(int j=0;j<=GAPT;j++) c.gaps[j] += cnt[j];
+  }
+
+  // the birthdays from the top 18 bits of two numbers
+  void birthdays(const uint64_t *v, int n){
+    for(int i=0;i<n && _years;i++){
+      uint64_t u = v[i]>>(_w - 18);
+      if(!_half){
+	_days[_ndays] = u<<18;
+      } else {
+	_days[_ndays++] |= u;
+	if(_ndays == BDAYM) year();
+      }
+      _half = !_half;
+    }
+  }
+
+  void year(){
+    uint64_t *d = radixsort36(_days, _tmp, BDAYM), *sp = d == _days ? _tmp : _days;
+    sp[0] = d[0];
+    for(int i=1;i<BDAYM;i++) sp[i] = d[i] - d[i-1];
+    sp = radixsort36(sp, d, BDAYM);
+    for(int i=1;i<BDAYM;i++) c.dups += sp[i] == sp[i-1];
+    c.years++;
+    _years--;
+    _ndays = 0;
+  }
+public:
+  counts c;
+
+  teststream(int w, uint64_t years):_w(w), _years(years){}
+
+  // the next n <= NBUF numbers
+  void put(const uint64_t *v, int n){
+    if(_w == 64){
+      bits(v, n);
+    } else {
+      // concatenate the w bits of the numbers
+      uint64_t acc = _acc;
+      int nacc = _nacc, nw = 0;
+      for(int i=0;i<n;i++){
+	uint64_t x = v[i];
+	acc |= x<<nacc;
+	nacc += _w;
+	if(nacc >= 64){
+	  _words[nw++] = acc;
+	  nacc -= 64;
+	  acc = nacc ? x>>(_w - nacc) : 0;
+	}
+      }
+      _acc = acc;
+      _nacc = nacc;
+      bits(_words, nw);
+    }
+    gaps(v, n);
+    if(_years) birthdays(v, n);
+  }
+};
+
+/*************************************************************************
+ * p-values                                                              *
+ *************************************************************************/
+
+// the regularized incomplete gamma functions P(a, x) by its series and
+// Q(a, x) = 1 - P(a, x) by its continued fraction
+static double gammaseries(double a, double x){
+  double ap = a, del = 1/a, sum = del;
+  for(int i=0;i<1000000 && fabs(del) > fabs(sum)*1e-16;i++){
+    ap += 1;
+    del *= x/ap;
+    sum += del;
+  }
+  return sum*exp(-x + a*log(x) - lgamma(a));
+}
+
+static double gammafraction(double a, double x){
+  const double tiny = 1e-300;
+  double b = x + 1 - a, c = 1/tiny, d = 1/b, h = d;
+  for(int i=1;i<1000000;i++){
+    double an = -i*(i - a);
+    b += 2;
+    d = an*d + b; if(fabs(d) < tiny) d = tiny;
+    c = b + an/c; if(fabs(c) < tiny) c = tiny;
+    d = 1/d;
+    double del = d*c;
+    h *= del;
+    if(fabs(del - 1) < 1e-16) break;
+  }
+  return exp(-x + a*log(x) - lgamma(a))*h;
+}
+
+static double gammap(double a, double x){
+  if(x <= 0) return 0;
+  return x < a + 1 ? gammaseries(a, x) : 1 - gammafraction(a, x);
+}
+
+static double gammaq(double a, double x){
+  if(x <= 0) return 1;
+  return x < a + 1 ? 1 - gammaseries(a, x) : gammafraction(a, x);
+}
+
+// the chi-square of the observed counts o against the probabilities p
+static double chi2(const uint64_t *o, const double *p, int n){
+  double N = 0, s = 0;
+  for(int i=0;i<n;i++) N += o[i];
+  for(int i=0;i<n;i++){
+    double e = N*p[i], d = o[i] - e;
+    s += d*d/e;
+  }
+  return s;
+}
+
+struct result {
+  const char *test;
+  double samples;
+  const char *unit;
+  std::string statistic;
+  double p;
+  bool twosided;  // p is already two-sided, otherwise p close to 1 is suspicious too
+};
+
+static std::string fmt(const char *f, double a, double b = 0){
+  char s[64];
+  snprintf(s, sizeof(s), f, a, b);
+  return s;
+}
+
+static std::vector<result> evaluate(const counts &c){
+  std::vector<result> r;
+
+  double z = (2.0*c.ones - c.nbits)/sqrt((double)c.nbits);
+  r.push_back({"frequency", (double)c.nbits, "bits", fmt("z = %.3f", z), erfc(fabs(z)/sqrt(2.0)), true});
+
+  double pg[GAPT+1], q = 1.0/(1<<(24 - GAPBITS)), t = 1, ng = 0;
+  for(int i=0;i<GAPT;i++){ pg[i] = q*t; t *= 1 - q; }
+  pg[GAPT] = t;
+  for(int i=0;i<=GAPT;i++) ng += c.gaps[i];
+  double x = chi2(c.gaps, pg, GAPT+1);
+  r.push_back({"gap [0,1/8)", ng, "gaps", fmt("chi2(%.0f) = %.1f", GAPT, x), gammaq(GAPT/2.0, x/2), false});
+
+  // Poisson with the mean m^3/(4n) per year
+  double lambda = c.years*pow(BDAYM, 3)/(4*pow(2, BDAYBITS));
+  r.push_back({"birthday spacings", (double)c.years, "years",
+	fmt("%.0f dups, %.0f expected", c.dups, lambda), c.dups ? gammap(c.dups, lambda) : 1, false});
+
+  // P(rank r) = 2^(r(2M-r)-M^2) prod_{i<r} (1-2^(i-M))^2/(1-2^(i-r))
+  double pr[3];
+  for(int k=0;k<2;k++){
+    int rk = 32 - k;
+    double s = ldexp(1, rk*(64 - rk) - 1024);
+    for(int i=0;i<rk;i++) s *= pow(1 - ldexp(1, i - 32), 2)/(1 - ldexp(1, i - rk));
+    pr[k] = s;
+  }
+  pr[2] = 1 - pr[0] - pr[1];
+  x = chi2(c.ranks, pr, 3);
+  r.push_back({"matrix rank 32x32", (double)(c.ranks[0] + c.ranks[1] + c.ranks[2]), "matrices",
+	fmt("chi2(2) = %.2f", x), gammaq(1, x/2), false});
+
+  // the complexity of an even number of random bits is M/2 + d with the
+  // probability 2^(2d-1), d <= 0, and 2^(-2d), d > 0
+  const double plc[7] = {1.0/96, 1.0/32, 1.0/8, 1.0/2, 1.0/4, 1.0/16, 1.0/48};
+  double nlc = 0;
+  for(int i=0;i<7;i++) nlc += c.lc[i];
+  x = chi2(c.lc, plc, 7);
+  r.push_back({"linear complexity 500", nlc, "blocks", fmt("chi2(6) = %.2f", x), gammaq(3, x/2), false});
+  return r;
+}
+
+// "" for a plausible p-value, "unusual", "suspicious" or "FAIL"
+static const char *verdict(const result &r){
+  double q = r.twosided ? r.p : std::min(r.p, 1 - r.p);
+  if(q < 1e-10) return "FAIL";
+  if(q < 1e-5) return "suspicious";
+  if(q < 1e-3) return "unusual";
+  return "";
+}
+
+/*************************************************************************
+ * the battery                                                           *
+ *************************************************************************/
+
+static std::vector<result> runsource(const sourcedef &s, int nt){
+  uint64_t n = opts.size*1e9*8/s.bits/nt; // numbers per thread
+  n = (n + NBUF - 1)/NBUF*NBUF;
+  std::vector<counts> c(nt);
+  std::vector<double> tgen(nt), ttest(nt); // the seconds of the generation and of the tests
+  std::vector<std::thread> w;
+  auto t0 = std::chrono::steady_clock::now();
+  for(int k=0;k<nt;k++)
+    w.emplace_back([&, k](){
+	typedef std::chrono::steady_clock clock;
+	std::unique_ptr<source> g(s.make(opts.seed, k));
+	teststream t(s.bits, BDAYYEARS/nt + (k < (int)(BDAYYEARS%nt)));
+	alignas(64) uint64_t v[NBUF];
+	clock::duration dg(0), dt(0);
+	for(uint64_t i=0;i<n;i+=NBUF){
+	  auto a = clock::now();
+	  g->fill(v);
+	  auto b = clock::now();
+	  t.put(v, NBUF);
+	  dg += b - a;
+	  dt += clock::now() - b;
+	}
+	c[k] = t.c;
+	tgen[k] = std::chrono::duration<double>(dg).count();
+	ttest[k] = std::chrono::duration<double>(dt).count();
+      });
+  for(auto &t : w) t.join();
+  double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  counts sum;
+  for(const counts &a : c) sum += a;
+  double sg = 0, st = 0;
+  for(int k=0;k<nt;k++){ sg += tgen[k]; st += ttest[k]; }
+
+  double gb = (double)n*nt*s.bits/8e9;
+  printf("%s: %d bits per number, %.2f GB in %d threads, %.2f s, %.2f GB/s\n", s.name, s.bits, gb, nt,
+	 dt, gb/dt);
+  printf("  per thread: generator %.2f GB/s, tests %.2f GB/s\n", gb/sg, gb/st);
+  std::vector<result> r = evaluate(sum);
+  for(const result &a : r)
+    printf("  %-22s %9.3g %-9s %-34s p = %-10.4g %s\n", a.test, a.samples, a.unit, a.statistic.c_str(),
+	   a.p, verdict(a));
+  fflush(stdout);
+  return r;
+}
+
+void usage(int argc, char **argv){
+  (void) argc;
+  printf("Parallel statistical test battery of the RANLUX++ and RANLUX generators.\n");
+  printf("Every thread tests its own jumped substream, the counts of all threads\n");
+  printf("give one p-value per test: frequency, gap, birthday spacings, 32x32 binary\n");
+  printf("matrix rank and linear complexity. The exit status is 1 if a test fails\n");
+  printf("(p < 1e-10, or 1 - p < 1e-10 for the one-sided tests).\n\n");
+  printf("Usage: %s [options]\n", argv[0]);
+  printf("  options:\n");
+  printf("    --size GB     gigabytes of random bits per source (default %g)\n", opts.size);
+  printf("    --threads N   number of threads (default: one per cpu)\n");
+  printf("    --seed S      seed of the generators (default %d)\n", opts.seed);
+  printf("    --p P         luxury of ranluxpp in numbers (default %d)\n", opts.p);
+  printf("    --lux L       luxury of ranluxI_* in states (default %d)\n", opts.lux);
+  printf("    --filter S    test the sources with S in the name only\n");
+  printf("  sources:\n");
+  for(const sourcedef &s : sources) printf("    %-24s -- %d bits per number\n", s.name, s.bits);
+}
+
+int main(int argc, char **argv){
+  for(int i=1;i<argc;i++){
+    const char *a = argv[i], *v = (i + 1 < argc) ? argv[i+1] : NULL;
+    if(!strcmp(a, "--size") && v){ opts.size = atof(v); i++; }
+    else if(!strcmp(a, "--threads") && v){ opts.threads = atoi(v); i++; }
+    else if(!strcmp(a, "--seed") && v){ opts.seed = atoi(v); i++; }
+    else if(!strcmp(a, "--p") && v){ opts.p = atoi(v); i++; }
+    else if(!strcmp(a, "--lux") && v){ opts.lux = atoi(v); i++; }
+    else if(!strcmp(a, "--filter") && v){ opts.filter = v; i++; }
+    else { usage(argc, argv); return 1; }
+  }
+  if(opts.size <= 0 || opts.threads < 0 || opts.p < 1 || opts.lux < 1){ usage(argc, argv); return 1; }
+  int nt = opts.threads ? opts.threads : std::thread::hardware_concurrency();
+  if(nt < 1) nt = 1;
+
+  struct row { const char *name; std::vector<result> r; };
+  std::vector<row> rows;
+  for(const sourcedef &s : sources){
+    if(opts.filter && !strstr(s.name, opts.filter)) continue;
+    rows.push_back({s.name, runsource(s, nt)});
+  }
+  if(rows.empty()){ usage(argc, argv); return 1; }
+
+  printf("\nSummary of the p-values (seed %d, ranluxpp p=%d, ranluxI_* lux=%d):\n", opts.seed, opts.p,
+	 opts.lux);
+  printf("  %-24s %10s %10s %10s %10s %10s\n", "source", "frequency", "gap", "birthday", "rank",
+	 "lincomp");
+  int nfail = 0, nsusp = 0;
+  for(const row &w : rows){
+    printf("  %-24s", w.name);
+    for(const result &a : w.r){
+      const char *v = verdict(a);
+      nfail += !strcmp(v, "FAIL");
+      nsusp += !strcmp(v, "suspicious");
+      printf(" %9.3g%c", a.p, !strcmp(v, "FAIL") ? '!' : *v ? '?' : ' ');
+    }
+    printf("\n");
+  }
+  printf("%zu tests, %d suspicious, %d failed\n", rows.size()*rows[0].r.size(), nsusp, nfail);
+  return nfail ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This program benchmarks the RANLUX++ generators, the conventional     *
+ * RANLUX implementations and the standard C++ RANLUX engines in a       *
+ * uniform way and reports the results in JSON.                          *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#include "bench.h"
+#include "ranluxpp.h"
+#include "ranlux.h"
+#include "ranluxauto.h"
+#include "ranluxstd.h"
+#include "cpuarch.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <random>
+
+// the number by number output of a generator g() of the type T
+template<typename T, class G>
+static jsonobj scalarbench(const std::string &name, const char *type, double bits, G &g){
+  return measure(name, type, "scalar", bits, [&g](size_t n){
+      T s = 0;
+      for(size_t i=0;i<n;i++) s += g();
+      return (double)s;
+    });
+}
+
+// ranluxpp -- the LCG with the given skipping
+static void bench_ranluxpp(std::vector<jsonobj> &res, int p){
+  std::string name = "ranluxpp p=" + std::to_string(p);
+  ranluxpp g(3124, p);
+  const size_t M = 1024;
+  static float af[M];
+  static double ad[M];
+  if(selected(name + " float scalar"))
+    res.push_back(measure(name, "float", "scalar", 24, [&g](size_t n){
+	  float s = 0;
+	  for(size_t i=0;i<n;i++) s += g(0.0f);
+	  return (double)s;
+	}));
+  if(selected(name + " double scalar"))
+    res.push_back(measure(name, "double", "scalar", 52, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i++) s += g(0.0);
+	  return s;
+	}));
+  if(selected(name + " float array"))
+    res.push_back(measure(name, "float", "array", 24, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i+=M){ g.getarray(M, af); s += af[0]; }
+	  return s;
+	}));
+  if(selected(name + " double array"))
+    res.push_back(measure(name, "double", "array", 52, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i+=M){ g.getarray(M, ad); s += ad[0]; }
+	  return s;
+	}));
+  if(selected(name + " state raw"))
+    res.push_back(measure(name, "state", "raw", 576, [&g](size_t n){
+	  for(size_t i=0;i<n;i++) g.nextstate();
+	  return (double)g.getstate()[0];
+	}));
+}
+
+// the conventional RANLUX generators, the raw API skips states of
+// nlanes generators without delivering the numbers
+template<class G>
+static void bench_ranluxI(std::vector<jsonobj> &res, const char *name, int nlanes){
+  const int p = 17;
+  if(selected(std::string(name) + " float scalar")){
+    G g(3124, p);
+    res.push_back(scalarbench<float>(name, "float", 24, g));
+  }
+  if(selected(std::string(name) + " state raw")){
+    G g(3124, p);
+    res.push_back(measure(name, "state", "raw", 576*nlanes, [&g](size_t k){
+	  g.nextstate(k);
+	  return (double)g();
+	}));
+  }
+}
+
+// the SIMD generators delivering the scalar sequence
+template<class G>
+static void bench_sequence(std::vector<jsonobj> &res, const char *name){
+  std::string n = std::string(name) + " sequence";
+  if(!selected(n + " float scalar")) return;
+  G g(3124, 17);
+  g.initsequence(3124);
+  res.push_back(scalarbench<float>(n, "float", 24, g));
+}
+
+// the standard and the std-compatible engines
+template<class G>
+static void bench_std(std::vector<jsonobj> &res, const char *name, const char *type, double bits){
+  if(!selected(std::string(name) + " " + type + " scalar")) return;
+  G g;
+  res.push_back(scalarbench<uint64_t>(name, type, bits, g));
+}
+
+// every engine, output type and API
+void bench_engines(std::vector<jsonobj> &res){
+  bench_ranluxpp(res, 2048);
+  bench_ranluxpp(res, 24*17);
+
+  bench_ranluxI<ranluxI_scalar>(res, "ranluxI_scalar p=408", 1);
+  if(selected("ranluxI48_scalar p=408 double scalar")){
+    ranluxI48_scalar g(3124, 17);
+    res.push_back(scalarbench<double>("ranluxI48_scalar p=408", "double", 48, g));
+  }
+  bench_ranluxI<ranluxI_multi<2>>(res, "ranluxI_multi<2> p=408", 2);
+  bench_ranluxI<ranluxI_multi<4>>(res, "ranluxI_multi<4> p=408", 4);
+  bench_ranluxI<ranluxI_SSE>(res, "ranluxI_SSE p=408", 4);
+  bench_sequence<ranluxI_SSE>(res, "ranluxI_SSE p=408");
+#ifdef __AVX2__
+  bench_ranluxI<ranluxI_AVX>(res, "ranluxI_AVX p=408", 8);
+  bench_sequence<ranluxI_AVX>(res, "ranluxI_AVX p=408");
+#endif
+#ifdef __AVX512F__
+  bench_ranluxI<ranluxI_AVX512>(res, "ranluxI_AVX512 p=408", 16);
+  bench_sequence<ranluxI_AVX512>(res, "ranluxI_AVX512 p=408");
+#endif
+  if(selected("ranluxI_auto p=408 float scalar")){
+    ranluxI_auto<float> g(3124, 17);
+    res.push_back(scalarbench<float>("ranluxI_auto p=408", "float", 24, g));
+  }
+  if(selected("ranluxI_auto p=408 double scalar")){
+    ranluxI_auto<double> g(3124, 17);
+    res.push_back(scalarbench<double>("ranluxI_auto p=408", "double", 48, g));
+  }
+  if(selected("ranluxpp_James lux=3 float array")){
+    ranluxpp_James g(3124, 3);
+    static float a[1024];
+    res.push_back(measure("ranluxpp_James lux=3", "float", "array", 24, [&g](size_t n){
+	  double s = 0;
+	  for(size_t i=0;i<n;i+=1024){ g.ranlux(a, 1024); s += a[0]; }
+	  return s;
+	}));
+  }
+
+  bench_std<ranlux24pp>(res, "ranlux24pp", "uint24", 24);
+  bench_std<ranlux48pp>(res, "ranlux48pp", "uint48", 48);
+  bench_std<std::ranlux24>(res, "std::ranlux24", "uint24", 24);
+  bench_std<std::ranlux48>(res, "std::ranlux48", "uint48", 48);
+}
+
+struct benchsuite {
+  const char *name, *description;
+  void (*run)(std::vector<jsonobj> &);
+};
+
+static const benchsuite suites[] = {
+  {"engines", "every engine, output type and API", bench_engines},
+  {"kernels", "latency and throughput of the assembly kernels", bench_kernels},
+  {"latency", "per call latency percentiles of the scalar draws", bench_latency},
+  {"scaling", "aggregate and per thread throughput of N pinned threads", bench_scaling},
+  {"reference", "RANLUX next to Philox, xoshiro, PCG64 and MT19937", bench_reference},
+  {"sweep", "luxury and block size sweeps with the ranluxpp crossover", bench_sweep},
+  {"setup", "construction, reseeding, skip setting and jumps per operation", bench_setup},
+  {"roofline", "bulk fill rate against the store bandwidth of L1 to DRAM", bench_roofline},
+};
+
+void usage(int argc, char **argv){
+  (void) argc;
+  printf("Unified benchmark of the RANLUX++ and RANLUX generators.\n");
+  printf("Time stamp counter cycles, ns and GB/s per number are reported with\n");
+  printf("their spread over repeated runs, optionally as JSON.\n\n");
+  printf("Usage: %s [options] suite\n", argv[0]);
+  printf("  suite:\n");
+  for(const benchsuite &s : suites) printf("    %-10s -- %s\n", s.name, s.description);
+  printf("  options:\n");
+  printf("    --repeat N    timed runs of every benchmark (default %d)\n", opts.repeat);
+  printf("    --time S      seconds per run (default %g), a warm-up run sizes it\n", opts.time);
+  printf("    --cpu N       pin to the cpu N, -1 -- no pinning (default: the current cpu)\n");
+  printf("    --filter S    run the benchmarks with S in the name only\n");
+  printf("    --json FILE   write the results as JSON to FILE, - for stdout (the table goes to stderr)\n");
+  printf("    --baseline F  the baseline file (default %s), keyed by the CPU model,\n", opts.baseline);
+  printf("                  a different kernel or compiler is reported as a warning\n");
+  printf("    --save-baseline  store the cycles per number of this run in the baseline\n");
+  printf("    --compare     compare with the baseline, the exit status is 2 if a benchmark\n");
+  printf("                  is slower beyond the tolerance with 95%% confidence\n");
+  printf("    --tolerance P tolerated slowdown in percent (default %g)\n", 100*opts.tolerance);
+  printf("    --p L         luxury values of the sweep in numbers, e.g. 24,408,2048\n");
+  printf("    --blocks L    getarray block sizes of the sweep, e.g. 1,1e3,1e6\n");
+  printf("    --csv FILE    write the sweep points as CSV to FILE, - for stdout\n");
+  printf("    --threads L   thread counts of the scaling suite, e.g. 1,2,4 (default:\n");
+  printf("                  powers of 2 up to the number of cpus)\n");
+  printf("    --pinning P   cpu order of the scaling threads: cores -- physical cores\n");
+  printf("                  first, smt -- SMT siblings together, sockets -- alternate\n");
+  printf("                  the sockets, none -- no pinning (default cores)\n");
+  printf("    --perf        collect cycles, instructions, branch, L1D and LLC misses\n");
+  printf("                  and context switches with perf_event_open\n");
+  printf("    --perf-raw S  also the raw events S = name=0xconfig,... e.g. port micro-ops\n");
+}
+
+int main(int argc, char **argv){
+  const benchsuite *suite = NULL;
+  for(int i=1;i<argc;i++){
+    const char *a = argv[i], *v = (i + 1 < argc) ? argv[i+1] : NULL;
+    if(!strcmp(a, "--repeat") && v){ opts.repeat = atoi(v); i++; }
+    else if(!strcmp(a, "--time") && v){ opts.time = atof(v); i++; }
+    else if(!strcmp(a, "--cpu") && v){ opts.cpu = atoi(v); i++; }
+    else if(!strcmp(a, "--filter") && v){ opts.filter = v; i++; }
+    else if(!strcmp(a, "--json") && v){ opts.json = v; i++; }
+    else if(!strcmp(a, "--perf")){ opts.perf = true; }
+    else if(!strcmp(a, "--baseline") && v){ opts.baseline = v; i++; }
+    else if(!strcmp(a, "--save-baseline")){ opts.save = true; }
+    else if(!strcmp(a, "--compare")){ opts.compare = true; }
+    else if(!strcmp(a, "--tolerance") && v){ opts.tolerance = atof(v)/100; i++; }
+    else if(!strcmp(a, "--p") && v){ opts.sweepp = v; i++; }
+    else if(!strcmp(a, "--blocks") && v){ opts.sweepblock = v; i++; }
+    else if(!strcmp(a, "--csv") && v){ opts.csv = v; i++; }
+    else if(!strcmp(a, "--threads") && v){ opts.threads = v; i++; }
+    else if(!strcmp(a, "--pinning") && v){ opts.pinning = v; i++; }
+    else if(!strcmp(a, "--perf-raw") && v){ opts.perf = true; opts.perfraw = v; i++; }
+    else {
+      for(const benchsuite &s : suites) if(!strcmp(a, s.name)) suite = &s;
+      if(!suite){ usage(argc, argv); return 1; }
+    }
+  }
+  if(!suite || opts.repeat < 1 || opts.time <= 0){ usage(argc, argv); return 1; }
+  if(strcmp(opts.pinning, "cores") && strcmp(opts.pinning, "smt") && strcmp(opts.pinning, "sockets")
+     && strcmp(opts.pinning, "none")){ usage(argc, argv); return 1; }
+
+  if(opts.cpu == -2) opts.cpu = sched_getcpu();
+  if(opts.cpu >= 0 && !pincpu(opts.cpu)){
+    fprintf(stderr, "Cannot pin to the cpu %d, running unpinned.\n", opts.cpu);
+    opts.cpu = -1;
+  }
+
+  if(opts.perf){
+    perf = new perfcounters(opts.perfraw);
+    if(!perf->available()){
+      fprintf(stderr, "No performance counters (%s), the timings only are reported.\n", perf->status().c_str());
+      delete perf;
+      perf = NULL;
+    } else if(perf->status() != "ok")
+      fprintf(stderr, "Some performance counters are not available (%s).\n", perf->status().c_str());
+  }
+
+  // with the JSON on stdout the table goes to stderr
+  FILE *jsonout = NULL;
+  if(opts.json && !strcmp(opts.json, "-")){
+    fflush(stdout);
+    jsonout = fdopen(dup(1), "w");
+    dup2(2, 1);
+  }
+
+  jsonobj host = hostinfo();
+  printf("Suite %s on %s, TSC %.3f GHz, cpu %d\n", suite->name, getarch(), tscghz(), opts.cpu);
+  std::vector<jsonobj> res;
+  suite->run(res);
+
+  if(opts.json){
+    jsonobj o, op;
+    op.add("repeat", opts.repeat).add("time", opts.time).add("cpu", opts.cpu)
+      .add("filter", opts.filter ? opts.filter : "");
+    o.add("host", host).add("suite", suite->name).add("options", op).add("results", res);
+    FILE *f = jsonout ? jsonout : fopen(opts.json, "w");
+    if(!f){ perror(opts.json); return 1; }
+    fprintf(f, "%s\n", o.str().c_str());
+    fclose(f);
+  }
+  delete perf;
+  if(opts.save && !savebaseline(opts.baseline)) return 1;
+  if(opts.compare){
+    int nreg = comparebaseline(opts.baseline, opts.tolerance);
+    if(nreg < 0) return 1;
+    if(nreg > 0) return 2;
+  }
+  return 0;
+}
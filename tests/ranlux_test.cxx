@@ -21,11 +21,14 @@
  *************************************************************************/
 
 #include "ranlux.h"
+#include "ranluxauto.h"
 #include <stdio.h>
 #include <string.h>
 #include <signal.h>
 #include <inttypes.h>
 #include <chrono>
+#include <vector>
+#include <thread>
 using namespace std::chrono;
 
 // time generation of 2 10^9 random numbers
@@ -83,6 +86,292 @@ void test_sameseed(){
 #endif
 }
 
+// compare skipping via the LCG with the subtract-with-borrow recurrence
+template<class T>
+bool jumptest(const char *name, int nlanes){
+  const int nskip[] = {1, 7, 100, 150, 1000, 12345, 1000003};
+  for(int n : nskip){
+    T g1(3124), g2(3124);
+    for(int k=n;k>0;k-=1000) g1.nextstate(k<1000?k:1000);
+    g2.jump(n);
+    for(int i=0;i<nlanes*24*3;i++){
+      float x1 = g1(), x2 = g2();
+      if(x1 != x2){
+	printf("%s: test failed after skipping %d states at number %d: %g != %g\n",name,n,i,x1,x2);
+	return false;
+      }
+    }
+  }
+  printf("%s: the LCG jump and the ordinary skipping are identical.\n",name);
+  return true;
+}
+
+void test_jump(){
+  jumptest<ranluxI_scalar>("scalar", 1);
+  jumptest<ranluxI_SSE>("SSE2", 4);
+#ifdef __AVX2__
+  jumptest<ranluxI_AVX>("AVX2", 8);
+#endif
+
+  float rvec[200];
+  ranluxI_James a;
+  printf("Restoring the RANLUX generator at kount = 10^12 ...\n");
+  auto start = high_resolution_clock::now();
+  a.rluxgo(4,7674985,0,1000);
+  auto end = high_resolution_clock::now();
+  std::chrono::duration<double> diff = end-start;
+  a.ranlux(rvec,200);
+  printf("Done in %g s. Next and 200th numbers are: %10.6f %10.6f\n",diff.count(),rvec[0],rvec[199]);
+}
+
+// the SIMD generators initialized by initsequence have to deliver
+// the scalar sequence, time both for 2 10^8 numbers
+template<class T>
+bool sequencetest(const char *name){
+  const int lux[] = {1, 4, 17, 100};
+  for(int p : lux){
+    ranluxI_scalar g1(3124, p);
+    T g2(3124, p); g2.initsequence(3124);
+    for(int i=0;i<1000*1000;i++){
+      float x1 = g1(), x2 = g2();
+      if(x1 != x2){
+	printf("%s: test failed for p=%d at number %d: %g != %g\n",name,24*p,i,x1,x2);
+	return false;
+      }
+      // the jumps in the sequence mode follow the scalar ones
+      if(i%100003 == 7){
+	g1.jump(i); g2.jump(i);
+      }
+    }
+  }
+  int N = 200*1000*1000;
+  ranluxI_scalar g1(3124);
+  T g2(3124); g2.initsequence(3124);
+  float x1 = 0, x2 = 0;
+  auto t0 = high_resolution_clock::now();
+  for(int i=0;i<N;i++) x1 += g1();
+  auto t1 = high_resolution_clock::now();
+  for(int i=0;i<N;i++) x2 += g2();
+  auto t2 = high_resolution_clock::now();
+  duration<double> d1 = t1 - t0, d2 = t2 - t1;
+  printf("%s: the sequence is identical to the scalar one, %g s vs %g s (scalar) for %d numbers%s\n",
+	 name, d2.count(), d1.count(), N, x1 == x2 ? "" : " -- sums differ!");
+  return x1 == x2;
+}
+
+void test_sequence(){
+  sequencetest<ranluxI_SSE>("SSE2");
+#ifdef __AVX2__
+  sequencetest<ranluxI_AVX>("AVX2");
+#endif
+#ifdef __AVX512F__
+  sequencetest<ranluxI_AVX512>("AVX-512");
+#endif
+}
+
+// the interleaved generators seeded with the same seed have to duplicate
+// the scalar version, compare the skipping speed
+template<int N>
+void multitest(){
+  int M = 1000*1000, nstates = 100;
+  ranluxI_scalar g1(3124);
+  ranluxI_multi<N> g2(3124); g2.init(3124,1);
+  for(int i=0;i<M/24;i++){
+    float x1[24];
+    for(int k=0;k<24;k++) x1[k] = g1();
+    for(int l=0;l<N;l++){
+      for(int k=0;k<24;k++){
+	float x2 = g2();
+	if(x1[k] != x2){
+	  printf("%d generators: test failed at block %d: %g != %g\n",N,i,x1[k],x2);
+	  return;
+	}
+      }
+    }
+    g1.nextstate(1 + i%7); g2.nextstate(1 + i%7);
+  }
+  char name[32];
+  sprintf(name, "%d interleaved", N);
+  jumptest<ranluxI_multi<N>>(name, N);
+
+  auto t0 = high_resolution_clock::now();
+  for(int i=0;i<M;i++) g1.nextstate(nstates);
+  auto t1 = high_resolution_clock::now();
+  for(int i=0;i<M;i++) g2.nextstate(nstates);
+  auto t2 = high_resolution_clock::now();
+  duration<double> d1 = t1 - t0, d2 = t2 - t1;
+  printf("%d generators: the same seed duplicates the scalar version, "
+	 "%.2f ns per state vs %.2f ns per state (scalar)\n",
+	 N, 1e9*d2.count()/(N*(double)M*nstates), 1e9*d1.count()/((double)M*nstates));
+}
+
+// the 48-bit generator has to deliver the numbers of the scalar one in
+// pairs, compare the speed
+void test48(){
+  const int lux[] = {1, 4, 17, 100};
+  for(int p : lux){
+    ranluxI_scalar g1(3124, p);
+    ranluxI48_scalar g2(3124, p);
+    for(int i=0;i<1000*1000;i++){
+      double x1 = g1(), x2 = g2();
+      x1 += g1()*(1.0/0x1p24);
+      if(x1 != x2){
+	printf("48-bit: test failed for p=%d at number %d: %.17g != %.17g\n",24*p,i,x1,x2);
+	return;
+      }
+      // jump by whole blocks
+      if(i%12 == 11 && i%1001 < 12){
+	g1.jump(1 + i); g2.jump(1 + i);
+      }
+    }
+  }
+  printf("48-bit: the generator delivers the scalar sequence in pairs.\n");
+
+  int M = 1000*1000, nstates = 100;
+  ranluxI_scalar g1(3124);
+  ranluxI48_scalar g2(3124);
+  auto t0 = high_resolution_clock::now();
+  for(int i=0;i<M;i++) g1.nextstate(nstates);
+  auto t1 = high_resolution_clock::now();
+  for(int i=0;i<M;i++) g2.nextstate(nstates);
+  auto t2 = high_resolution_clock::now();
+  duration<double> d1 = t1 - t0, d2 = t2 - t1;
+  printf("48-bit: %.2f ns per state vs %.2f ns per state (scalar)\n",
+	 1e9*d2.count()/((double)M*nstates), 1e9*d1.count()/((double)M*nstates));
+  uint32_t y1[24], c1, y2[24], c2;
+  g1.getstate(y1, c1); g2.getstate(y2, c2);
+  if(c1 != c2 || memcmp(y1, y2, sizeof(y1)))
+    printf("48-bit: the states differ after %d states!\n", M*nstates);
+}
+
+// save the state of g, load it to h and compare the following numbers
+template<class T, class U>
+bool restoretest(const char *name, T &g, U &h){
+  const int N = 5000;
+  for(int i=0;i<1234;i++) g();
+  std::vector<uint8_t> buf(g.save(NULL));
+  g.save(buf.data());
+  double x[N];
+  for(int i=0;i<N;i++) x[i] = g();
+  if(!h.load(buf.data(), buf.size())){
+    printf("%s: the checkpoint is not accepted.\n", name);
+    return false;
+  }
+  for(int i=0;i<N;i++){
+    double y = h();
+    if(x[i] != y){
+      printf("%s: test failed at number %d after restoring: %g != %g\n", name, i, x[i], y);
+      return false;
+    }
+  }
+  printf("%s: restored from a %zu byte checkpoint.\n", name, buf.size());
+  return true;
+}
+
+// migrate a generator lane from its checkpoint to ranluxpp and compare
+// the next states
+template<class T>
+bool migratetest(const char *name, T &g, int lane, int p){
+  std::vector<uint8_t> buf(g.save(NULL));
+  g.save(buf.data());
+  ranluxpp r(0, 24*p);
+  if(!getlcgstate(r.getstate(), (const ranluxI_checkpoint*)buf.data(), buf.size(), lane)) return false;
+  uint64_t x[9];
+  for(int i=0;i<100;i++){
+    r.nextstate();
+    g.nextstate(p);
+    g.save(buf.data());
+    getlcgstate(x, (const ranluxI_checkpoint*)buf.data(), buf.size(), lane);
+    for(int j=0;j<9;j++)
+      if(x[j] != r.getstate()[j]){
+	printf("%s: the migrated state differs at step %d.\n", name, i);
+	return false;
+      }
+  }
+  // truncated checkpoints and missing lanes are rejected
+  for(size_t n : {(size_t)0, sizeof(ranluxI_checkpoint), buf.size() - 1})
+    if(getlcgstate(x, (const ranluxI_checkpoint*)buf.data(), n, lane)){
+      printf("%s: a checkpoint truncated to %zu bytes is accepted.\n", name, n);
+      return false;
+    }
+  if(getlcgstate(x, (const ranluxI_checkpoint*)buf.data(), buf.size(), 16)){
+    printf("%s: the missing lane 16 is accepted.\n", name);
+    return false;
+  }
+  printf("%s: lane %d migrated to ranluxpp.\n", name, lane);
+  return true;
+}
+
+void test_checkpoint(){
+  { ranluxI_scalar g(3124), h(1); restoretest("scalar", g, h); }
+  { ranluxI48_scalar g(3124), h(1); restoretest("48-bit", g, h); }
+  { ranluxI_multi<2> g(3124), h(1); restoretest("2 interleaved", g, h); }
+  { ranluxI_multi<4> g(3124), h(1); restoretest("4 interleaved", g, h); }
+  { ranluxI_SSE g(3124), h(1); restoretest("SSE2", g, h); }
+#ifdef __AVX2__
+  { ranluxI_AVX g(3124), h(1); restoretest("AVX2", g, h); }
+  { ranluxI_AVX g(3124); ranluxI_scalar h(1); g.initsequence(3124);
+    restoretest("AVX2 sequence -> scalar", g, h); }
+  { ranluxI_scalar g(3124); ranluxI_AVX h(1);
+    restoretest("scalar -> AVX2 sequence", g, h); }
+  { ranluxI_AVX g(3124); ranluxI_SSE h(1); g.initsequence(3124);
+    restoretest("AVX2 sequence -> SSE2 sequence", g, h); }
+#endif
+#ifdef __AVX512F__
+  { ranluxI_AVX512 g(3124), h(1); restoretest("AVX-512", g, h); }
+  { ranluxI_AVX512 g(3124); ranluxI_scalar h(1); g.initsequence(3124);
+    restoretest("AVX-512 sequence -> scalar", g, h); }
+#endif
+  { ranluxI_scalar g(3124); migratetest("scalar", g, 0, 17); }
+  { ranluxI48_scalar g(3124); migratetest("48-bit", g, 0, 17); }
+  { ranluxI_multi<4> g(3124); migratetest("4 interleaved", g, 3, 17); }
+  { ranluxI_SSE g(3124); migratetest("SSE2", g, 2, 17); }
+#ifdef __AVX2__
+  { ranluxI_AVX g(3124); migratetest("AVX2", g, 5, 17); }
+#endif
+}
+
+// every engine of ranluxI_auto has to deliver the scalar sequence,
+// print the calibrated cost model and the selected engines
+template<typename T, class R>
+bool autotest(const char *type){
+  typedef ranluxI_auto<T> A;
+  const int lux[] = {1, 17, 100};
+  for(int p : lux){
+    for(int b=0;b<A::NBACKENDS;b++){
+      R g1(3124, p);
+      A g2(3124, p, b);
+      for(int i=0;i<100*1000;i++){
+	T x1 = g1(), x2 = g2();
+	if(x1 != x2){
+	  printf("%s: test failed for the %s engine and p=%d at number %d: %g != %g\n",
+		 type, A::backendname(g2.getbackend()), 24*p, i, (double)x1, (double)x2);
+	  return false;
+	}
+      }
+    }
+  }
+  printf("%s: all engines deliver the same sequence.\n", type);
+  return true;
+}
+
+void test_auto(){
+  autotest<float, ranluxI_scalar>("float");
+  autotest<double, ranluxI48_scalar>("double");
+  typedef ranluxI_auto<double> A;
+  A::calibrate();
+  printf("Cost model, ns per 24-bit number = slope*p + offset\n");
+  for(int b=0;b<A::NBACKENDS;b++){
+    double o = A::cost(b, 0);
+    printf("  %-14s slope %6.3f offset %6.2f\n", A::backendname(b), A::cost(b, 1) - o, o);
+  }
+  const int lux[] = {1, 2, 4, 8, 17, 32, 64, 100, 200};
+  for(int p : lux)
+    printf("  p=%-5d float: %-14s double: %s\n", 24*p,
+	   ranluxI_auto<float>::backendname(ranluxI_auto<float>::select(p)),
+	   A::backendname(A::select(p)));
+}
+
 // compare results with the original FORTRAN code:
 // http://www.cpc.cs.qub.ac.uk/summaries/ACPR_v1_0.html or
 // http://www.cpc.cs.qub.ac.uk/summaries/ACPR_v2_0.html
@@ -138,6 +427,98 @@ void original_test(){
   printf("  Next and 200th numbers are: %10.6f %10.6f\n",rvec[0],rvec[199]);
 }
 
+// compare the bulk output of the LCG based emulation of the original
+// FORTRAN routine with its number by number output at every luxury level
+// and for a custom p, the bulk arrays are requested by chunks of varying size
+void test_james_bulk(){
+  const int lux[] = {0, 1, 2, 3, 4, 100, 1000};
+  const int N = 100000;
+  float *v1 = new float[N], *v2 = new float[N];
+  bool ok = true;
+  for(int l : lux){
+    ranluxpp_James a, b;
+    a.rluxgo(l, 31415, 0, 0); b.rluxgo(l, 31415, 0, 0);
+    for(int i=0;i<N;i++) a.ranlux(v1+i, 1);
+    for(int i=0,n=1;i<N;i+=n,n=(3*n+1)%97) b.ranlux(v2+i, (n<N-i)?n:N-i);
+    for(int i=0;i<N;i++)
+      if(v1[i] != v2[i]){
+	printf("Test failed for luxury %d at number %d: %g != %g\n",l,i,v1[i],v2[i]);
+	ok = false;
+	break;
+      }
+  }
+  if(ok) printf("Test successfully passed: the bulk output is identical for all luxury levels.\n");
+  delete[] v1; delete[] v2;
+}
+
+// the instrumentation counters of the generators and of the threads
+// against the counts following from the sizes of the caches and states
+void test_stats(){
+  if(!ranluxstats::enabled){
+    printf("The instrumentation counters are not compiled in, build with \"make STATS=yes\".\n");
+    return;
+  }
+  bool ok = true;
+  auto check = [&ok](const char *name, const ranluxstats &s, uint64_t states, uint64_t refills,
+		     uint64_t jumps, uint64_t discarded){
+    printf("%-24s ", name);
+    s.print(stdout);
+    if(s.states != states || s.refills != refills || s.jumps != jumps || s.discarded != discarded){
+      printf("Test failed: expected states %" PRIu64 ", refills %" PRIu64 ", jumps %" PRIu64
+	     ", discarded bits %" PRIu64 "\n", states, refills, jumps, discarded);
+      ok = false;
+    }
+  };
+  ranluxstats t0 = ranluxstats_thread();
+
+  // ranluxpp: 24 floats or 11 doubles per state, 4 bits of a state are
+  // lost for the doubles, the arrays bypass the caches
+  ranluxpp g(1, 2048);
+  check("ranluxpp construction", g.getstats(), 0, 0, 1, 0);
+  g.resetstats();
+  for(int i=0;i<240;i++) g(0.0f);
+  for(int i=0;i<110;i++) g(0.0);
+  check("ranluxpp scalar", g.getstats(), 20, 20, 0, 40);
+  g.resetstats();
+  std::vector<double> d(1100);
+  g.getarray(d.size(), d.data());
+  g.jump(1000);
+  check("ranluxpp array and jump", g.getstats(), 100, 0, 1, 400);
+
+  // the conventional RANLUX skips p - 1 of p states for every block
+  ranluxI_scalar s(1, 17);
+  s.resetstats();
+  for(int i=0;i<240;i++) s();
+  check("ranluxI_scalar", s.getstats(), 10*17, 10, 0, 10*16*576);
+#ifdef __AVX2__
+  ranluxI_AVX v(1, 17);
+  v.resetstats();
+  for(int i=0;i<8*240;i++) v();
+  v.jump(100);
+  check("ranluxI_AVX", v.getstats(), 8*10*17 + 8*100, 10, 1, 8*10*16*576);
+#endif
+
+  // the thread counters sum all generators of the thread, the total
+  // includes the finished threads
+  ranluxstats t1 = ranluxstats_thread(), a0 = ranluxstats_total();
+  ranluxstats gs = g.getstats() + s.getstats();
+  int nseeds = 2; // the seeding at the construction of g and s
+#ifdef __AVX2__
+  gs += v.getstats();
+  nseeds++;
+#endif
+  check("thread", t1 - t0, gs.states + 20, gs.refills + 20, gs.jumps + nseeds, gs.discarded + 40);
+  std::vector<std::thread> th;
+  for(int k=0;k<4;k++)
+    th.emplace_back([k](){
+	ranluxpp q(k + 2, 2048);
+	for(int i=0;i<24*100;i++) q(0.0f);
+      });
+  for(auto &t : th) t.join();
+  check("4 finished threads", ranluxstats_total() - a0, 4*100, 4*100, 4, 0);
+  if(ok) printf("Test successfully passed: the counters agree with the generated numbers.\n");
+}
+
 template<typename T>
 void output_to_file(const char * filename) {
 
@@ -189,6 +570,9 @@ void output_to_file(const char * filename) {
   }
 }
 
+// the diagnostic messages of the generators go to stdout
+static void logstdout(const char *msg){ fputs(msg, stdout); }
+
 void usage(int argc, char **argv){
   (void) argc;
   printf("Program to test the performance of the optimized RANLUX implementations (with skipping).\n");
@@ -208,10 +592,20 @@ void usage(int argc, char **argv){
   printf("        10 -- output stream of 64-bit random numbers. Filename required. Uses the SSE2 skipping.\n");
   printf("        11 -- output stream of 64-bit random numbers. Filename required. Uses the AVX2 skipping.\n");
   printf("              Example: %s 11 >(PractRand-RNG_test stdin32 -tlmax 32T -multithreaded)\n", argv[0]);
+  printf("        12 -- compare skipping via the LCG jump with the ordinary skipping (consistency check)\n");
+  printf("        13 -- compare the bulk and the number by number output of the LCG based\n");
+  printf("              emulation of the FORTRAN code (consistency check)\n");
+  printf("        14 -- compare the SIMD generators delivering one sequence with the scalar skipping\n");
+  printf("        15 -- compare the interleaved scalar generators with the scalar skipping\n");
+  printf("        16 -- compare the 48-bit generator with the scalar skipping\n");
+  printf("        17 -- save and restore the generator states (consistency check)\n");
+  printf("        18 -- compare the engines of the luxury adaptive generator and calibrate them\n");
+  printf("        19 -- check the instrumentation counters of the generators and threads (make STATS=yes)\n");
 }
 
 int main(int argc, char **argv){
   if(argc==1||argc>3) { usage(argc,argv); return 0;}
+  ranlux_setlogger(logstdout);
 
   int ntest = atoi(argv[1]);
   if ( ntest == 0 ){
@@ -245,6 +639,23 @@ int main(int argc, char **argv){
   } else if(ntest == 11){
     if (argc !=3)  { usage(argc,argv); return 0;}
     output_to_file<ranluxI_AVX>(argv[2]);
+  } else if(ntest == 12){
+    test_jump();
+  } else if(ntest == 13){
+    test_james_bulk();
+  } else if(ntest == 14){
+    test_sequence();
+  } else if(ntest == 15){
+    multitest<2>();
+    multitest<4>();
+  } else if(ntest == 16){
+    test48();
+  } else if(ntest == 17){
+    test_checkpoint();
+  } else if(ntest == 18){
+    test_auto();
+  } else if(ntest == 19){
+    test_stats();
   } else {
     usage(argc,argv);
   }
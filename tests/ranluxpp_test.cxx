@@ -22,6 +22,8 @@
 
 #include "ranluxpp.h"
 #include "ranlux.h"
+#include "ranluxstd.h"
+#include "swblcg.h"
 #include "cpuarch.h"
 #include <stdio.h>
 #include <string.h>
@@ -29,7 +31,13 @@
 #include <cxxabi.h>
 #include <signal.h>
 #include <inttypes.h>
+#include <random>
+#include <sstream>
+#include <vector>
 #include <chrono>
+#include <memory>
+#include <thread>
+#include <cpuid.h>
 using namespace std::chrono;
 
 // time generation of 2 10^9 random numbers
@@ -217,6 +225,545 @@ void compare_ranlux_0(){
   printf("The transformed LCG state and the RANLUX sequence is identical for %d steps.\n",N);
 }
 
+// compare the LCG based engines with the standard ones
+template<class Tstd, class Tpp>
+bool compare_std(const char *name){
+  const unsigned long long N = 1000*1000;
+  auto fail = [name](const char *what, unsigned long long i){
+    printf("%s: test failed (%s) at number %llu.\n",name,what,i);
+    return false;
+  };
+  for(auto s : {0ull, 1ull, 3124ull, 19780503ull, 2147483563ull, 0xffffffffull, 0x10000000005ull}){
+    Tstd g0(s); Tpp g1(s);
+    for(unsigned long long i=0;i<N;i++) if(g0() != g1()) return fail("seed",i);
+  }
+  Tstd g0; Tpp g1;
+  g0.seed(); g1.seed();
+  for(unsigned long long i=0;i<N;i++) if(g0() != g1()) return fail("default seed",i);
+  std::seed_seq q0{1,2,3,4}, q1{1,2,3,4};
+  g0.seed(q0); g1.seed(q1);
+  for(unsigned long long i=0;i<N;i++) if(g0() != g1()) return fail("seed_seq",i);
+  for(unsigned long long z : {0ull, 1ull, 5ull, 22ull, 23ull, 24ull, 100ull, 12345ull, 1000000ull}){
+    g0.discard(z); g1.discard(z);
+    for(int i=0;i<1000;i++) if(g0() != g1()) return fail("discard",z);
+  }
+  printf("%s: test successfully passed, the sequence is identical to the standard one.\n",name);
+  return true;
+}
+
+void compare_std(){
+  compare_std<std::ranlux24, ranlux24pp>("ranlux24pp");
+  compare_std<std::ranlux48, ranlux48pp>("ranlux48pp");
+}
+
+// compare the generic SWB-LCG engine with
+// std::discard_block_engine<std::subtract_with_carry_engine<UInt,w,s,r>, p, r>
+template<typename UInt, int w, int s, int r, int p>
+bool compare_swb(){
+  typedef std::subtract_with_carry_engine<UInt,w,s,r> swb;
+  const int N = 100*1000;
+  char name[64];
+  snprintf(name, sizeof(name), "SWB(w=%d, s=%d, r=%d, p=%d)", w, s, r, p);
+  for(unsigned seed : {1u, 3124u, 19780503u}){
+    swb e(seed);
+    std::discard_block_engine<swb, p, r> g0(e);
+
+    // read the long lag and the carry of the standard engine
+    std::stringstream ss; ss << e;
+    uint64_t x[r]; int c;
+    for(int i=0;i<r;i++) ss >> x[i];
+    ss >> c;
+
+    swblcg_engine<w,r,s> g1(p);
+    g1.setstate(x, c);
+    for(int i=0;i<N;i++){
+      uint64_t z0 = g0(), z1 = g1();
+      if(z0 != z1){
+	printf("%s: test failed at number %d: %lx != %lx\n", name, i, z0, z1);
+	return false;
+      }
+    }
+  }
+  printf("%s: test successfully passed, the sequence is identical to the standard one.\n", name);
+  return true;
+}
+
+// compare the generic modular arithmetic and conversions with
+// the specialized kernels and the standard SWB engines
+void compare_swblcg(){
+  typedef swblcg<24,24,10> lcg;
+  ranluxpp g(1, 2048);
+  uint64_t y[24], y1[24], x[9], x1[9];
+  int N = 100*1000, nfail = 0;
+  for(int i=0;i<N && !nfail;i++){
+    g.nextstate();
+    const uint64_t *z = g.getstate(), *a = g.getmultiplier();
+    for(int j=0;j<9;j++) x[j] = x1[j] = z[j];
+    lcg::mulmod(x, a);
+    lcg::mulmod_generic(x1, a);
+    for(int j=0;j<9;j++) nfail += x[j] != x1[j];
+    bool c = lcg::getswbseq(y, z), c1 = lcg::getswbseq_generic(y1, z);
+    nfail += c != c1;
+    for(int j=0;j<24;j++) nfail += y[j] != y1[j];
+    lcg::getlcgstate(x, y, c);
+    lcg::getlcgstate_generic(x1, y, c);
+    for(int j=0;j<9;j++) nfail += (x[j] != x1[j]) + (x[j] != z[j]);
+  }
+  if(nfail)
+    printf("swblcg<24,24,10>: the generic code differs from the specialized kernels.\n");
+  else
+    printf("swblcg<24,24,10>: the generic code is identical to the specialized kernels for %d states.\n", N);
+
+  compare_swb<uint_fast32_t, 24, 10, 24, 24>();
+  compare_swb<uint_fast32_t, 24, 10, 24, 223>();
+  compare_swb<uint_fast64_t, 48, 5, 12, 12>();
+  compare_swb<uint_fast64_t, 48, 5, 12, 389>();
+  compare_swb<uint32_t, 32, 3, 17, 17>();
+  compare_swb<uint32_t, 32, 3, 17, 100>();
+  compare_swb<uint_fast16_t, 16, 11, 37, 37>();
+  compare_swb<uint64_t, 64, 7, 13, 13>();
+  compare_swb<uint64_t, 64, 7, 13, 200>();
+}
+
+// compare the batched conversions with the single state ones and time them
+void compare_batch(){
+  const size_t N = 1000*1000 + 5; // not a multiple of the batch
+  std::vector<uint64_t> x(9*N), x1(9*N);
+  std::vector<uint32_t> y(24*N), y1(24*N);
+  bool *k = new bool[N], *k1 = new bool[N];
+  ranluxpp g(2018, 2048);
+  for(size_t i=0;i<N;i++){
+    g.nextstate();
+    for(int j=0;j<9;j++) x[9*i+j] = g.getstate()[j];
+  }
+
+  auto t0 = high_resolution_clock::now();
+  for(size_t i=0;i<N;i++) k[i] = getranluxseq(&y[24*i], &x[9*i]);
+  auto t1 = high_resolution_clock::now();
+  getranluxseq(y1.data(), k1, x.data(), N);
+  auto t2 = high_resolution_clock::now();
+  for(size_t i=0;i<N;i++) getlcgstate(&x1[9*i], &y[24*i], k[i]);
+  auto t3 = high_resolution_clock::now();
+  getlcgstate(x1.data(), y.data(), k, N);
+  auto t4 = high_resolution_clock::now();
+
+  size_t nfail = 0;
+  for(size_t i=0;i<N;i++) nfail += k[i] != k1[i];
+  for(size_t i=0;i<24*N;i++) nfail += y[i] != y1[i];
+  for(size_t i=0;i<9*N;i++) nfail += x[i] != x1[i];
+  delete [] k; delete [] k1;
+
+  auto ns = [N](high_resolution_clock::time_point a, high_resolution_clock::time_point b){
+    return duration<double, std::nano>(b - a).count()/N;
+  };
+  printf("getranluxseq: %.1f ns per state, batched %.1f ns per state\n", ns(t0,t1), ns(t1,t2));
+  printf("getlcgstate:  %.1f ns per state, batched %.1f ns per state\n", ns(t2,t3), ns(t3,t4));
+  if(nfail)
+    printf("Test failed. The batched conversions differ in %zu words.\n", nfail);
+  else
+    printf("Test successfully passed. The batched conversions are identical for %zu states.\n", N);
+}
+
+extern "C" {
+  void _mul9x9_mul(uint64_t *b, const uint64_t *a);
+  void _remainder(uint64_t *b);
+  void _mul9x9_mulx(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9_mulxadox(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9mod_mulx(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  void _mul9x9mod_mulxadox(uint64_t *out, const uint64_t *a, const uint64_t *b);
+};
+
+// The reference 576-bit arithmetic the kernels are validated against:
+// the schoolbook product and the remainder by the bit by bit long
+// division, slow but evidently correct.
+namespace refmod {
+  // m = 2^576 - 2^240 + 1 with a zero limb on top
+  static void modulus(uint64_t m[10]){
+    for(int i=0;i<10;i++) m[i] = 0;
+    for(int i=240;i<576;i++) m[i/64] |= 1UL<<(i%64);
+    m[0] |= 1;
+  }
+
+  // z = x*y
+  static void mul(uint64_t z[18], const uint64_t *x, const uint64_t *y){
+    for(int i=0;i<18;i++) z[i] = 0;
+    for(int i=0;i<9;i++){
+      unsigned __int128 c = 0;
+      for(int j=0;j<9;j++){
+	c += (unsigned __int128)x[i]*y[j] + z[i+j];
+	z[i+j] = c;
+	c >>= 64;
+      }
+      z[i+9] = c;
+    }
+  }
+
+  // r = z mod m for z of n limbs
+  static void mod(uint64_t r[9], const uint64_t *z, int n){
+    uint64_t m[10], t[10] = {0};
+    modulus(m);
+    for(int i=64*n-1;i>=0;i--){
+      // t <- 2t + the next bit of z, t < 2m fits 10 limbs
+      for(int k=9;k>0;k--) t[k] = t[k]<<1 | t[k-1]>>63;
+      t[0] = t[0]<<1 | (z[i/64]>>(i%64) & 1);
+      int k = 9;
+      while(k>0 && t[k] == m[k]) k--;
+      if(t[k] >= m[k]){
+	uint64_t b = 0;
+	for(int j=0;j<10;j++){
+	  unsigned __int128 d = (unsigned __int128)t[j] - m[j] - b;
+	  t[j] = d;
+	  b = (d>>64) & 1;
+	}
+      }
+    }
+    for(int i=0;i<9;i++) r[i] = t[i];
+  }
+
+  static void mulmod(uint64_t *r, const uint64_t *x, const uint64_t *y){
+    uint64_t z[18];
+    mul(z, x, y);
+    mod(r, z, 18);
+  }
+
+  // x - m if x >= m, for x < 2^576 < 2m the reduced x, otherwise x
+  static void reduce(uint64_t *r, const uint64_t *x){
+    uint64_t m[10], t[9], b = 0;
+    modulus(m);
+    for(int j=0;j<9;j++){
+      unsigned __int128 d = (unsigned __int128)x[j] - m[j] - b;
+      t[j] = d;
+      b = (d>>64) & 1;
+    }
+    for(int j=0;j<9;j++) r[j] = b ? x[j] : t[j];
+  }
+
+  // x <- x^n mod m
+  static void powmod(uint64_t *x, uint64_t n){
+    uint64_t res[9] = {1};
+    while(n){
+      if(n&1) mulmod(res, res, x);
+      n >>= 1;
+      if(n) mulmod(x, x, x);
+    }
+    for(int i=0;i<9;i++) x[i] = res[i];
+  }
+}
+
+// extended instructions used by the kernels, CPUID leaf 7
+static bool cpuid7(int bit){
+  unsigned a, b, c, d;
+  if(!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+  return (b>>bit)&1;
+}
+static bool always(){ return true; }
+static bool hasbmi2(){ return cpuid7(8); }
+static bool hasadx(){ return cpuid7(8) && cpuid7(19); }
+
+// the kernels under validation, out = a*b mod m for the modular ones
+// and the full 1152-bit product otherwise
+struct mulkernel {
+  const char *name;
+  bool (*available)();
+  void (*mul)(uint64_t *out, const uint64_t *a, const uint64_t *b);
+  bool mod;
+  bool reduced; // the result is always below m
+};
+
+static const mulkernel mulkernels[] = {
+    // the first one is the kernel the others have to be bit-identical to,
+  // its result is below 2^576 but not always below m
+  {"_mul9x9mod_mulxadox", hasadx, _mul9x9mod_mulxadox, true, false},
+  {"_mul9x9mod_mulx", hasbmi2, _mul9x9mod_mulx, true, false},
+  {"_mul9x9_mul+_remainder", always, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      uint64_t t[18];
+      memcpy(t, b, 9*sizeof(uint64_t));
+      _mul9x9_mul(t, a);
+      _remainder(t);
+      memcpy(out, t, 9*sizeof(uint64_t));
+    }, true, false},
+  {"_mul9x9_mulx+_remainder", hasbmi2, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      uint64_t t[18];
+      _mul9x9_mulx(t, a, b);
+      _remainder(t);
+      memcpy(out, t, 9*sizeof(uint64_t));
+    }, true, false},
+  {"_mul9x9_mulxadox+_remainder", hasadx, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      uint64_t t[18];
+      _mul9x9_mulxadox(t, a, b);
+      _remainder(t);
+      memcpy(out, t, 9*sizeof(uint64_t));
+    }, true, false},
+  {"mul9x9mod", always, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      memcpy(out, b, 9*sizeof(uint64_t));
+      mul9x9mod(out, a);
+    }, true, false},
+  {"swblcg<24,24,10> generic", always, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      memcpy(out, b, 9*sizeof(uint64_t));
+      swblcg<24,24,10>::mulmod_generic(out, a);
+    }, true, true},
+  {"_mul9x9_mul", always, [](uint64_t *out, const uint64_t *a, const uint64_t *b){
+      memcpy(out, b, 9*sizeof(uint64_t));
+      _mul9x9_mul(out, a);
+    }, false, false},
+  {"_mul9x9_mulx", hasbmi2, _mul9x9_mulx, false, false},
+  {"_mul9x9_mulxadox", hasadx, _mul9x9_mulxadox, false, false},
+};
+static const int NKERNELS = sizeof(mulkernels)/sizeof(mulkernels[0]);
+
+// the inputs next to the edges: around 0, m and 2^576, at the 2^240
+// fold, single limbs and bits, the multipliers of the generator
+static std::vector<std::vector<uint64_t>> edgeinputs(){
+  std::vector<std::vector<uint64_t>> v;
+  uint64_t m[10];
+  refmod::modulus(m);
+  auto add = [&v](std::vector<uint64_t> x){ v.push_back(x); };
+  auto addm = [&v, &m](int64_t d){ // m + d
+    std::vector<uint64_t> x(m, m + 9);
+    unsigned __int128 c = (unsigned __int128)x[0] + (uint64_t)d;
+    x[0] = c;
+    uint64_t carry = d < 0 ? ~0UL : 0;
+    for(int i=1;i<9;i++){ c = (c>>64) + x[i] + carry; x[i] = c; }
+    v.push_back(x);
+  };
+  for(uint64_t k : {0UL, 1UL, 2UL, 3UL, ~0UL}){
+    std::vector<uint64_t> x(9, 0);
+    x[0] = k;
+    add(x);
+  }
+  for(int d : {-2, -1, 0, 1, 2}) addm(d);
+  add(std::vector<uint64_t>(9, ~0UL));             // 2^576 - 1
+  std::vector<uint64_t> x(9, ~0UL);
+  x[0] = ~1UL;
+  add(x);                                          // 2^576 - 2
+  for(int b : {64, 239, 240, 241, 575}){
+    std::vector<uint64_t> y(9, 0);
+    y[b/64] = 1UL<<(b%64);
+    add(y);
+    for(int i=0;i<9;i++) y[i] = ~y[i];             // 2^576 - 1 - 2^b
+    add(y);
+  }
+  for(int i=0;i<9;i++){
+    std::vector<uint64_t> y(9, 0);
+    y[i] = ~0UL;
+    add(y);
+  }
+  std::vector<uint64_t> a(ranluxpp::geta(), ranluxpp::geta() + 9);
+  add(a);
+  ranluxpp g(0, 2048);
+  add(std::vector<uint64_t>(g.getmultiplier(), g.getmultiplier() + 9));
+  for(uint64_t p : {0x5555555555555555UL, 0xaaaaaaaaaaaaaaaaUL, 0xffffffff00000000UL})
+    add(std::vector<uint64_t>(9, p));
+  return v;
+}
+
+// check every available kernel against the reference and the first
+// kernel on the products of the edge inputs, of the edge and random ones
+// and of random ones, the cases are shared by the threads
+static void validate_products(const std::vector<std::vector<uint64_t>> &edge, size_t nrandom,
+			      std::vector<size_t> &ncases, std::vector<size_t> &nwrong,
+			      std::vector<size_t> &ndiffer, std::vector<size_t> &nabove, int t, int nt){
+  std::mt19937_64 r(3124 + t);
+  size_t ne = edge.size(), ncase = ne*ne + 2*nrandom;
+  bool gold = mulkernels[0].available();
+  for(size_t i=t;i<ncase;i+=nt){
+    uint64_t a[9], b[9];
+    for(int j=0;j<9;j++){ a[j] = r(); b[j] = r(); }
+    if(i < ne*ne){
+      memcpy(a, edge[i/ne].data(), sizeof(a));
+      memcpy(b, edge[i%ne].data(), sizeof(b));
+    } else if(i < ne*ne + nrandom){
+      memcpy(a, edge[i%ne].data(), sizeof(a));
+    }
+    uint64_t z[18], ref[9], first[9], firstred[9];
+    refmod::mul(z, a, b);
+    refmod::mod(ref, z, 18);
+    if(gold){
+      mulkernels[0].mul(first, a, b);
+      refmod::reduce(firstred, first);
+    }
+    for(int k=0;k<NKERNELS;k++){
+      const mulkernel &K = mulkernels[k];
+      if(!K.available()) continue;
+      uint64_t out[18], res[9];
+      K.mul(out, a, b);
+      ncases[k]++;
+      if(K.mod){
+	refmod::reduce(res, out);
+	nwrong[k] += memcmp(res, ref, sizeof(res)) != 0;
+	if(gold && memcmp(out, first, sizeof(first))){
+	  // a reduced kernel differs where the first one leaves x >= m
+	  if(K.reduced && memcmp(first, firstred, sizeof(first)) && !memcmp(out, firstred, sizeof(first)))
+	    nabove[k]++;
+	  else
+	    ndiffer[k]++;
+	}
+      } else {
+	nwrong[k] += memcmp(out, z, sizeof(z)) != 0;
+      }
+    }
+  }
+}
+
+// validate the modular multiplication kernels, the exponentiation and the
+// conversions between the LCG state and the RANLUX sequence against
+// the reference arithmetic, in parallel
+void validate_kernels(){
+  typedef swblcg<24,24,10> lcg;
+  auto start = high_resolution_clock::now();
+  int nt = std::thread::hardware_concurrency();
+  if(nt < 1) nt = 1;
+  const size_t NRANDOM = 20000, NCHAIN = 100000, NSEQ = 100000;
+  std::vector<std::vector<uint64_t>> edge = edgeinputs();
+  bool ok = true;
+
+  // products: the reference, the first kernel and the sums of the threads
+  {
+    std::vector<std::vector<size_t>> c(nt, std::vector<size_t>(NKERNELS)), w = c, d = c, u = c;
+    std::vector<std::thread> th;
+    for(int t=0;t<nt;t++)
+      th.emplace_back(validate_products, std::cref(edge), NRANDOM, std::ref(c[t]), std::ref(w[t]),
+		      std::ref(d[t]), std::ref(u[t]), t, nt);
+    for(auto &t : th) t.join();
+    for(int k=0;k<NKERNELS;k++){
+      const mulkernel &K = mulkernels[k];
+      if(!K.available()){
+	printf("%-28s not supported by the CPU, skipped\n", K.name);
+	continue;
+      }
+      size_t nc = 0, nw = 0, nd = 0, nu = 0;
+      for(int t=0;t<nt;t++){ nc += c[t][k]; nw += w[t][k]; nd += d[t][k]; nu += u[t][k]; }
+      printf("%-28s %zu products, %zu differ from the reference", K.name, nc, nw);
+      if(K.mod && k && mulkernels[0].available())
+	printf(", %zu not bit-identical to %s", nd, mulkernels[0].name);
+      if(nu) printf(" (%zu reduced where it is not)", nu);
+      printf("\n");
+      ok &= !nw && !nd;
+    }
+  }
+
+  // long chains x <- x*A of every modular kernel, bit-identical to the
+  // first kernel at every step and equal to x*A^n of the reference
+  {
+    ranluxpp g(0, 2048);
+    const uint64_t *A = g.getmultiplier();
+    uint64_t x0[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9}, xn[9], An[9];
+    memcpy(An, A, sizeof(An));
+    refmod::powmod(An, NCHAIN);
+    refmod::mulmod(xn, x0, An);
+    std::vector<std::vector<uint64_t>> chain(NKERNELS);
+    std::vector<size_t> nd(NKERNELS);
+    std::vector<std::thread> th;
+    for(int k=0;k<NKERNELS;k++){
+      if(!mulkernels[k].available() || !mulkernels[k].mod) continue;
+      th.emplace_back([k, &x0, A, &chain](){
+	  std::vector<uint64_t> &v = chain[k];
+	  v.resize(9*(NCHAIN + 1));
+	  memcpy(v.data(), x0, sizeof(x0));
+	  for(size_t i=0;i<NCHAIN;i++) mulkernels[k].mul(&v[9*(i+1)], A, &v[9*i]);
+	});
+    }
+    for(auto &t : th) t.join();
+    for(int k=0;k<NKERNELS;k++){
+      if(chain[k].empty()) continue;
+      uint64_t res[9];
+      refmod::reduce(res, &chain[k][9*NCHAIN]);
+      bool end = !memcmp(res, xn, sizeof(res));
+      size_t ndiff = 0;
+      if(k && !chain[0].empty())
+	for(size_t i=0;i<=NCHAIN;i++) ndiff += memcmp(&chain[k][9*i], &chain[0][9*i], sizeof(res)) != 0;
+      printf("%-28s chain of %zu multiplications: %s the reference", mulkernels[k].name, NCHAIN,
+	     end ? "ends at" : "does not end at");
+      if(k && !chain[0].empty()) printf(", %zu states not bit-identical", ndiff);
+      printf("\n");
+      ok &= end && !ndiff;
+    }
+  }
+
+  // the exponentiation of a, A = a^2048 and a random number for edge
+  // and random exponents
+  {
+    std::mt19937_64 r(2018);
+    size_t nfail = 0, n = 0;
+    std::vector<uint64_t> exps = {0, 1, 2, 3, 24, 2048, ~0UL, 1UL<<63, (1UL<<48) - 1};
+    for(int i=0;i<16;i++) exps.push_back(r());
+    ranluxpp g(0, 2048);
+    uint64_t bases[3][9];
+    memcpy(bases[0], ranluxpp::geta(), sizeof(bases[0]));
+    memcpy(bases[1], g.getmultiplier(), sizeof(bases[1]));
+    for(int j=0;j<9;j++) bases[2][j] = r();
+    refmod::mod(bases[2], bases[2], 9);
+    for(uint64_t e : exps)
+      for(auto &x : bases){
+	uint64_t y[9], z[9];
+	memcpy(y, x, sizeof(y));
+	memcpy(z, x, sizeof(z));
+	powmod(y, e);
+	refmod::powmod(z, e);
+	refmod::reduce(y, y);
+	nfail += memcmp(y, z, sizeof(y)) != 0;
+	n++;
+      }
+    printf("%-28s %zu exponentiations, %zu differ from the reference\n", "powmod", n, nfail);
+    ok &= !nfail;
+  }
+
+  // the LCG state to the RANLUX sequence and back, single, batched and
+  // the portable conversions, for reduced random states
+  {
+    std::vector<size_t> nfail(nt);
+    std::vector<std::thread> th;
+    for(int t=0;t<nt;t++)
+      th.emplace_back([t, nt, &nfail, &edge](){
+	  std::mt19937_64 r(42 + t);
+	  size_t n = NSEQ/nt + 1, f = 0;
+	  std::vector<uint64_t> x(9*n), x1(9*n);
+	  std::vector<uint32_t> y(24*n), y1(24*n);
+	  std::unique_ptr<bool[]> c(new bool[n]), c1(new bool[n]);
+	  for(size_t i=0;i<n;i++){
+	    uint64_t z[9];
+	    for(int j=0;j<9;j++) z[j] = r();
+	    if(i < edge.size() && t == 0) memcpy(z, edge[i].data(), sizeof(z));
+	    refmod::mod(&x[9*i], z, 9);
+	    bool zero = true;
+	    for(int j=0;j<9;j++) zero &= !x[9*i+j];
+	    if(zero) x[9*i] = 1; // the fixed point of the LCG
+	  }
+	  for(size_t i=0;i<n;i++){
+	    c[i] = getranluxseq(&y[24*i], &x[9*i]);
+	    getlcgstate(&x1[9*i], &y[24*i], c[i]);
+	    f += memcmp(&x1[9*i], &x[9*i], 9*sizeof(uint64_t)) != 0;
+	    uint64_t yg[24], xg[9];
+	    bool cg = lcg::getswbseq_generic(yg, &x[9*i]);
+	    f += cg != c[i];
+	    for(int j=0;j<24;j++) f += yg[j] != y[24*i+j];
+	    lcg::getlcgstate_generic(xg, yg, cg);
+	    f += memcmp(xg, &x[9*i], sizeof(xg)) != 0;
+	  }
+	  getranluxseq(y1.data(), c1.get(), x.data(), n);
+	  getlcgstate(x1.data(), y1.data(), c1.get(), n);
+	  for(size_t i=0;i<n;i++) f += c1[i] != c[i];
+	  f += y1 != y;
+	  f += x1 != x;
+	  nfail[t] = f;
+	});
+    for(auto &t : th) t.join();
+    size_t f = 0;
+    for(size_t x : nfail) f += x;
+    printf("%-28s %zu states, %zu mismatches\n", "getranluxseq/getlcgstate", (NSEQ/nt + 1)*nt, f);
+    ok &= !f;
+  }
+
+  duration<double> dt = high_resolution_clock::now() - start;
+  if(ok)
+    printf("Test successfully passed: the kernels agree with the reference arithmetic (%d threads, %.1f s).\n", nt, dt.count());
+  else
+    printf("Test failed: the kernels disagree with the reference arithmetic (%d threads, %.1f s).\n", nt, dt.count());
+}
+
+// the diagnostic messages of the generators go to stdout
+static void logstdout(const char *msg){ fputs(msg, stdout); }
+
 void usage(int argc, char **argv){
   (void) argc;
   printf("Program to test the performance of the Linear Congruential Generator with long integer modular multiplication.\n");
@@ -238,10 +785,17 @@ void usage(int argc, char **argv){
   printf("         5 -- time generation of 2 10^9 double random numbers (array)\n");
   printf("         6 -- output stream of 64-bit random numbers. Filename required.\n");
   printf("              Example: %s 6 >(PractRand-RNG_test stdin64 -tlmax 32T -multithreaded)\n", argv[0]);
+  printf("         7 -- compare ranlux24pp and ranlux48pp with std::ranlux24 and std::ranlux48\n");
+  printf("         8 -- compare the generic SWB-LCG framework with the specialized kernels\n");
+  printf("              and the standard subtract-with-carry engines\n");
+  printf("         9 -- compare the batched state conversions with the single state ones\n");
+  printf("        10 -- validate the multiplication kernels, powmod and the state conversions\n");
+  printf("              against a reference 576-bit arithmetic (in parallel)\n");
 }
 
 int main(int argc, char **argv){
   if(argc==1||argc>3) { usage(argc,argv); return 0;}
+  ranlux_setlogger(logstdout);
 
   int ntest = atoi(argv[1]);
   printf("Selected code path is optimized for the %s CPU architecture.\n",getarch());
@@ -260,6 +814,14 @@ int main(int argc, char **argv){
   } else if(ntest == 6){
     if (argc !=3)  { usage(argc,argv); return 0;}
     output_to_file(argv[2]);
+  } else if(ntest == 7){
+    compare_std();
+  } else if(ntest == 8){
+    compare_swblcg();
+  } else if(ntest == 9){
+    compare_batch();
+  } else if(ntest == 10){
+    validate_kernels();
   } else {
     usage(argc,argv);
   }
@@ -0,0 +1,163 @@
+/*************************************************************************
+ * Copyright (C) 2018,  Alexei Sibidanov                                 *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of the RANLUX++ random number generator.            *
+ *                                                                       *
+ * RANLUX++ is free software: you can redistribute it and/or modify it   *
+ * under the terms of the GNU Lesser General Public License as published *
+ * by the Free Software Foundation, either version 3 of the License, or  *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * RANLUX++ is distributed in the hope that it will be useful, but       *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+/*************************************************************************
+ * Self-contained reference implementations of popular fast generators   *
+ * used to put the RANLUX generators in perspective:                     *
+ *   Philox4x32-10 -- Salmon et al., SC'11, counter based                *
+ *   xoshiro256**  -- Blackman and Vigna, 2018                           *
+ *   PCG64         -- O'Neill, 2014, XSL-RR 128/64 output                *
+ *   MT19937       -- Matsumoto and Nishimura, 1998                      *
+ * All are std-like engines: result_type operator()().                   *
+ *************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+// splitmix64, to expand a seed into the state of the other generators
+class splitmix64 {
+  uint64_t _x;
+public:
+  splitmix64(uint64_t seed) : _x(seed) {}
+  uint64_t operator()(){
+    uint64_t z = (_x += 0x9e3779b97f4a7c15UL);
+    z = (z ^ (z>>30))*0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z>>27))*0x94d049bb133111ebUL;
+    return z ^ (z>>31);
+  }
+};
+
+// Philox4x32 with 10 rounds, the counter is incremented every 4 numbers
+class philox4x32 {
+  uint32_t _ctr[4], _key[2], _out[4];
+  int _i;
+  static uint32_t mulhilo(uint32_t a, uint32_t b, uint32_t &hi){
+    uint64_t p = (uint64_t)a*b;
+    hi = p>>32;
+    return p;
+  }
+public:
+  typedef uint32_t result_type;
+  philox4x32(uint64_t seed) : _ctr{0, 0, 0, 0}, _key{(uint32_t)seed, (uint32_t)(seed>>32)}, _i(4) {}
+
+  // the block for the counter c and the key k
+  static void block(uint32_t out[4], const uint32_t c[4], const uint32_t k[2]){
+    uint32_t x0 = c[0], x1 = c[1], x2 = c[2], x3 = c[3], k0 = k[0], k1 = k[1];
+    for(int r=0;r<10;r++){
+      uint32_t hi0, hi1;
+      uint32_t lo0 = mulhilo(0xD2511F53, x0, hi0);
+      uint32_t lo1 = mulhilo(0xCD9E8D57, x2, hi1);
+      x0 = hi1 ^ x1 ^ k0; x1 = lo1;
+      x2 = hi0 ^ x3 ^ k1; x3 = lo0;
+      k0 += 0x9E3779B9; k1 += 0xBB67AE85;
+    }
+    out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+  }
+
+  uint32_t operator()(){
+    if(_i == 4){
+      block(_out, _ctr, _key);
+      if(!++_ctr[0]) if(!++_ctr[1]) if(!++_ctr[2]) ++_ctr[3];
+      _i = 0;
+    }
+    return _out[_i++];
+  }
+};
+
+// xoshiro256**
+class xoshiro256ss {
+  uint64_t _s[4];
+  static uint64_t rotl(uint64_t x, int k){ return (x<<k) | (x>>(64 - k)); }
+public:
+  typedef uint64_t result_type;
+  xoshiro256ss(uint64_t seed){
+    splitmix64 sm(seed);
+    for(int i=0;i<4;i++) _s[i] = sm();
+  }
+  uint64_t operator()(){
+    uint64_t r = rotl(_s[1]*5, 7)*9, t = _s[1]<<17;
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+    _s[2] ^= t;
+    _s[3] = rotl(_s[3], 45);
+    return r;
+  }
+};
+
+// PCG64: 128-bit LCG with the XSL-RR output of the advanced state
+class pcg64 {
+  unsigned __int128 _s, _inc;
+  static unsigned __int128 mult(){
+    return (unsigned __int128)0x2360ED051FC65DA4UL<<64 | 0x4385DF649FCCF645UL;
+  }
+public:
+  typedef uint64_t result_type;
+  pcg64(uint64_t seed){
+    splitmix64 sm(seed);
+    _inc = ((unsigned __int128)sm()<<64 | sm())<<1 | 1;
+    _s = 0;
+    (*this)();
+    _s += (unsigned __int128)sm()<<64 | sm();
+    (*this)();
+  }
+  uint64_t operator()(){
+    _s = _s*mult() + _inc;
+    uint64_t x = (uint64_t)(_s>>64) ^ (uint64_t)_s;
+    int r = _s>>122;
+    return (x>>r) | (x<<((-r) & 63));
+  }
+};
+
+// MT19937, the 32-bit Mersenne Twister
+class mt19937ref {
+  static const int N = 624, M = 397;
+  uint32_t _mt[N];
+  int _i;
+  static uint32_t mix(uint32_t a, uint32_t b, uint32_t c){
+    uint32_t y = (a & 0x80000000u) | (b & 0x7fffffffu);
+    return c ^ (y>>1) ^ (-(y & 1) & 0x9908b0dfu);
+  }
+  void twist(){
+    int k = 0;
+    for(;k<N-M;k++) _mt[k] = mix(_mt[k], _mt[k+1], _mt[k+M]);
+    for(;k<N-1;k++) _mt[k] = mix(_mt[k], _mt[k+1], _mt[k+M-N]);
+    _mt[N-1] = mix(_mt[N-1], _mt[0], _mt[M-1]);
+    _i = 0;
+  }
+public:
+  typedef uint32_t result_type;
+  mt19937ref(uint32_t seed = 5489u){
+    _mt[0] = seed;
+    for(int k=1;k<N;k++) _mt[k] = 1812433253u*(_mt[k-1] ^ (_mt[k-1]>>30)) + k;
+    _i = N;
+  }
+  uint32_t operator()(){
+    if(_i >= N) twist();
+    uint32_t y = _mt[_i++];
+    y ^= y>>11;
+    y ^= (y<<7) & 0x9d2c5680u;
+    y ^= (y<<15) & 0xefc60000u;
+    return y ^ (y>>18);
+  }
+};
@@ -21,6 +21,7 @@
  * <http://www.gnu.org/licenses/>.                                       *
  *************************************************************************/
 
+#include "ranluxstd.h"
 #include <random>
 #include <stdio.h>
 #include <typeinfo>
@@ -71,6 +72,10 @@ void usage(int argc, char **argv){
   printf("         11 -- std::ranlux24 (p=223) to produce doubles with 48 random bits in mantissa.\n");
   printf("         12 -- std::ranlux48 (p=389) to produce floats with 24 random bits in mantissa.\n");
   printf("         13 -- std::ranlux48 (p=389) to produce doubles with 48 random bits in mantissa.\n");
+  printf("         14 -- ranlux24pp (std::ranlux24 via LCG) to produce floats with 24 random bits in mantissa.\n");
+  printf("         15 -- ranlux24pp (std::ranlux24 via LCG) to produce doubles with 48 random bits in mantissa.\n");
+  printf("         16 -- ranlux48pp (std::ranlux48 via LCG) to produce floats with 24 random bits in mantissa.\n");
+  printf("         17 -- ranlux48pp (std::ranlux48 via LCG) to produce doubles with 48 random bits in mantissa.\n");
 }
 
 int main(int argc, char **argv){
@@ -93,6 +98,10 @@ int main(int argc, char **argv){
   case 11: speedtest<std::ranlux24,double,48>("std::ranlux24"); break;
   case 12: speedtest<std::ranlux48,float,24>("std::ranlux48"); break;
   case 13: speedtest<std::ranlux48,double,48>("std::ranlux48"); break;
+  case 14: speedtest<ranlux24pp,float,24>("ranlux24pp"); break;
+  case 15: speedtest<ranlux24pp,double,48>("ranlux24pp"); break;
+  case 16: speedtest<ranlux48pp,float,24>("ranlux48pp"); break;
+  case 17: speedtest<ranlux48pp,double,48>("ranlux48pp"); break;
   default: usage(argc,argv); break;
   }
 }